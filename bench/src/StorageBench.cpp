@@ -0,0 +1,396 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "AgendaService.hpp"
+#include "Backend.hpp"
+#include "Storage.hpp"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+const int userCount = 20000;
+const int meetingCount = 400000;
+const int participatorCount = 3;
+
+/**
+ * run a workload a few times and report the best time per record
+ * @param name the name of the workload
+ * @param records the number of records one run touches
+ * @param workload the workload to measure
+ * @param rounds the number of runs
+ */
+void measure(const string &name, long long records,
+             const std::function<void(void)> &workload, int rounds = 5) {
+  double best = 0;
+
+  for (int round = 0; round < rounds; ++round) {
+    auto start = std::chrono::steady_clock::now();
+
+    workload();
+
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (round == 0 || elapsed.count() < best) best = elapsed.count();
+  }
+
+  std::printf("%-36s %12.2f ms %10.2f ns/record\n", name.c_str(), best / 1e6,
+              best / records);
+}
+
+string userName(int id) { return "user" + std::to_string(id); }
+
+/**
+ * write the benchmark tables as the CSV files to import
+ */
+void writeData(void) {
+  std::ofstream userStream(Path::userImportPath);
+
+  for (int i = 0; i < userCount; ++i)
+    userStream << "\"" << userName(i)
+               << "\",\"password\",\"user@email.com\",\"13800000000\"\n";
+
+  std::ofstream meetingStream(Path::meetingImportPath);
+
+  for (int i = 0; i < meetingCount; ++i) {
+    meetingStream << "\"" << userName(i % userCount) << "\",\"";
+
+    for (int j = 1; j <= participatorCount; ++j)
+      meetingStream << (j > 1 ? "&" : "")
+                    << userName((i + j * 7) % userCount);
+
+    Date start(2000 + i / (28 * 24 * 12), i / (28 * 24) % 12 + 1, i % 28 + 1,
+               i / 28 % 24, 0);
+    Date end(start.getYear(), start.getMonth(), start.getDay(),
+             start.getHour(), 30);
+
+    meetingStream << "\",\"" << Date::dateToString(start) << "\",\""
+                  << Date::dateToString(end) << "\",\"meeting" << i << "\"\n";
+  }
+}
+
+/**
+ * report the memory of the storage by component, and per meeting
+ * @param storage the storage
+ */
+void reportMemory(const Storage &storage) {
+  const Storage::MemoryStats stats = storage.memoryStats();
+  const std::pair<const char *, std::size_t> rows[] = {
+      {"records", stats.userRecords + stats.meetingRecords},
+      {"strings", stats.userStrings + stats.titleStrings},
+      {"participators", stats.participators},
+      {"username index and filter", stats.userIndex + stats.userFilter},
+      {"title index", stats.titleIndex},
+      {"meeting and schedule indexes",
+       stats.meetingIndex + stats.scheduleIndex + stats.calendarIndex},
+      {"pinned version", stats.version},
+      {"encoded records", stats.backend},
+      {"total", stats.total()}};
+
+  for (const auto &row : rows)
+    std::printf("memory: %-28s %12.2f MB\n", row.first, row.second / 1e6);
+
+  std::printf("memory: %-28s %12zu bytes\n", "per meeting",
+              stats.meetingBytes() / stats.meetings);
+  std::printf("memory: %-28s %12.2f MB\n", "interned names, whole process",
+              Symbols::bytes() / 1e6);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc > 1 && std::strcmp(argv[1], "--load-snapshot") == 0) {
+    std::shared_ptr<Storage> storage;
+
+    measure(
+        "load from binary snapshot", meetingCount,
+        [&storage]() { storage = Storage::getInstance(); }, 1);
+
+    return 0;
+  }
+
+  if (argc > 1 && std::strcmp(argv[1], "--load-partitions") == 0) {
+    std::shared_ptr<Storage> storage;
+
+    measure(
+        "load from partitions", meetingCount,
+        [&storage]() { storage = Storage::getInstance(); }, 1);
+
+    return 0;
+  }
+
+  writeData();
+
+  std::shared_ptr<Storage> storage;
+
+  // the instance loads the files only once
+  measure(
+      "import from CSV", meetingCount,
+      [&storage]() { storage = Storage::getInstance(); }, 1);
+
+  // a journal this long is folded into the files on the next sync. The
+  // first fold writes every partition from the import, later ones only the
+  // partitions the mutations fall in
+  for (const char *name : {"checkpoint of every partition",
+                           "checkpoint of one partition"}) {
+    for (int i = 0; i < 4096; ++i)
+      storage->updateUser(
+          [](const User &user) { return user.getName() == "user0"; },
+          [i](User &user) { user.setPhone(std::to_string(i)); });
+
+    measure(
+        name, meetingCount, [&storage]() { storage->sync(); }, 1);
+  }
+
+  reportMemory(*storage);
+
+  long long visited = 0;
+
+  measure("full meeting scan", meetingCount, [&]() {
+    storage->queryMeeting([&visited](const Meeting &) {
+      ++visited;
+      return false;
+    });
+  });
+
+  // a std::function filter picks the type-erased overload, which calls the
+  // filter indirectly for every record
+  std::function<bool(const Meeting &)> erased = [&visited](const Meeting &) {
+    ++visited;
+    return false;
+  };
+
+  measure("full meeting scan (std::function)", meetingCount,
+          [&]() { storage->queryMeeting(erased); });
+
+  measure("full meeting scan by sponsor", meetingCount, [&]() {
+    storage->queryMeeting([](const Meeting &meeting) {
+      return meeting.getSponsor() == "user0";
+    });
+  });
+
+  measure("count meetings by sponsor", meetingCount, [&]() {
+    visited += storage->countMeetings([](const Meeting &meeting) {
+      return meeting.getSponsor() == "user0";
+    });
+  });
+
+  // readers share the lock, so the scans run side by side on enough cores
+  const int readers = 4;
+
+  storage->setConcurrent(true);
+  measure("4 threads scanning by sponsor", readers * meetingCount, [&]() {
+    vector<std::thread> threads;
+
+    for (int i = 0; i < readers; ++i)
+      threads.emplace_back([&storage]() {
+        storage->countMeetings([](const Meeting &meeting) {
+          return meeting.getSponsor() == "user0";
+        });
+      });
+
+    for (std::thread &thread : threads) thread.join();
+  });
+  storage->setConcurrent(false);
+
+  measure("full user scan", userCount, [&]() {
+    storage->queryUser([&visited](const User &) {
+      ++visited;
+      return false;
+    });
+  });
+
+  measure("user meetings lookup", userCount, [&]() {
+    for (int i = 0; i < userCount; ++i)
+      visited += storage->queryMeeting(userName(i), [](const Meeting &) {
+                          return true;
+                        }).size();
+  });
+
+  // a window is a range seek in the calendar or in a user's schedule
+  const Date weekStart(2000, 3, 1, 0, 0);
+  const Date weekEnd(2000, 3, 7, 23, 59);
+
+  measure("weekly window of all meetings", meetingCount, [&]() {
+    visited += storage->queryMeeting(weekStart, weekEnd).size();
+  });
+
+  measure("weekly window of every user", userCount, [&]() {
+    for (int i = 0; i < userCount; ++i)
+      visited += storage->queryMeeting(userName(i), weekStart, weekEnd).size();
+  });
+
+  measure("username lookup", userCount, [&]() {
+    for (int i = 0; i < userCount; ++i)
+      visited += storage->userExists(userName(i));
+  });
+
+  measure("missing username lookup", userCount, [&]() {
+    for (int i = 0; i < userCount; ++i)
+      visited += storage->userExists("ghost" + std::to_string(i));
+  });
+
+  Storage::FilterStats filter = storage->filterStats();
+
+  std::printf("%-36s %10.4f%% seen %8.4f%% expected %8zu bytes\n",
+              "username filter false positives", 100 * filter.observedRate,
+              100 * filter.expectedRate, filter.bytes);
+
+  int created = 0;
+
+  // each sync only appends the new meeting to the journal
+  measure("create meeting and sync", 1000, [&]() {
+    for (int i = 0; i < 1000; ++i, ++created) {
+      Date start(1990, 1, 1, 0, 0);
+
+      storage->createMeeting(Meeting("user0", {"user1"}, start, start,
+                                     "new" + std::to_string(created)));
+      storage->sync();
+    }
+  });
+
+  // with the flusher running the writes only buffer their records
+  storage->startFlusher(std::chrono::milliseconds(5));
+  measure("create meeting with flusher running", 1000, [&]() {
+    for (int i = 0; i < 1000; ++i, ++created) {
+      Date start(1990, 1, 1, 0, 0);
+
+      storage->createMeeting(Meeting("user0", {"user1"}, start, start,
+                                     "new" + std::to_string(created)));
+    }
+    storage->flush();
+  });
+  storage->stopFlusher();
+  storage->setConcurrent(false);
+
+  // a transaction journals its mutations as one group and syncs once
+  measure("create meetings in a transaction", 1000, [&]() {
+    storage->transaction([&]() {
+      for (int i = 0; i < 1000; ++i, ++created) {
+        Date start(1990, 1, 1, 0, 0);
+
+        storage->createMeeting(Meeting("user0", {"user1"}, start, start,
+                                       "new" + std::to_string(created)));
+      }
+    });
+    storage->sync();
+  });
+
+  std::shared_ptr<const Version> version;
+
+  measure(
+      "pin first version", meetingCount,
+      [&]() { version = storage->pinVersion(); }, 1);
+
+  // a write makes the next version copy one chunk and share the rest
+  measure("create meeting and pin version", 1000, [&]() {
+    for (int i = 0; i < 1000; ++i, ++created) {
+      Date start(1990, 1, 1, 0, 0);
+
+      storage->createMeeting(Meeting("user0", {"user1"}, start, start,
+                                     "new" + std::to_string(created)));
+      version = storage->pinVersion();
+    }
+  });
+  version.reset();
+
+  std::printf("(%lld records visited)\n", visited);
+
+  measure(
+      "export binary snapshot", meetingCount,
+      [&storage]() { storage->exportSnapshot(); }, 1);
+
+  // the meeting partitions all change, but the records cached by the last
+  // checkpoint are copied instead of encoded again
+  measure(
+      "export after a meeting per partition", meetingCount,
+      [&]() {
+        for (int i = 0; i < 32; ++i, ++created) {
+          Date start(1990, 1, 1, 0, 0);
+
+          storage->createMeeting(Meeting(userName(i), {userName(i + 1)},
+                                         start, start,
+                                         "new" + std::to_string(created)));
+        }
+        storage->exportSnapshot();
+      },
+      3);
+
+  // only a new process starts from the snapshot
+  std::fflush(stdout);
+  std::system((string(argv[0]) + " --load-snapshot").c_str());
+
+  // or from the partitions, read side by side, once there is no snapshot
+  const string snapshotAside = string(Path::snapshotPath) + ".aside";
+
+  std::rename(Path::snapshotPath, snapshotAside.c_str());
+  std::system((string(argv[0]) + " --load-partitions").c_str());
+  std::rename(snapshotAside.c_str(), Path::snapshotPath);
+
+  // a migration through the service into csv tables of their own, one
+  // meeting at a time or as one batch. Each slot holds a meeting per pair of
+  // users
+  const string importDirectory = "data/import";
+  const int importUsers = 1000, importCount = 100000;
+  vector<AgendaService::MeetingRequest> batch;
+
+  for (int i = 0; i < importCount; ++i) {
+    const int pair = i % (importUsers / 2), slot = i / (importUsers / 2);
+    const string day = "2030-01-" + std::to_string(10 + slot / 24) + "/";
+    const string hour = day + std::to_string(10 + slot % 24 / 2);
+    const bool early = slot % 2 == 0;
+
+    batch.push_back({userName(2 * pair), "import" + std::to_string(i),
+                     hour + (early ? ":00" : ":30"),
+                     hour + (early ? ":29" : ":59"),
+                     {userName(2 * pair + 1)}});
+  }
+
+  for (bool batched : {false, true}) {
+    std::filesystem::remove_all(importDirectory);
+    std::filesystem::create_directories(importDirectory);
+
+    AgendaService service(
+        Storage::open(Backend::create("csv", importDirectory)));
+
+    for (int i = 0; i < importUsers; ++i)
+      service.userRegister(userName(i), "password", "user@email.com",
+                           "13800000000");
+
+    measure(
+        batched ? "import meetings as a batch" : "import meetings one by one",
+        importCount,
+        [&]() {
+          if (batched) {
+            service.createMeetings(batch);
+            return;
+          }
+
+          for (const auto &request : batch)
+            service.createMeeting(request.sponsor, request.title,
+                                  request.startDate, request.endDate,
+                                  request.participator);
+        },
+        1);
+  }
+
+  std::filesystem::remove_all(importDirectory);
+
+  // keep the benchmark data out of the data directory
+  storage->deleteUser([](const User &) { return true; });
+  storage->deleteMeeting([](const Meeting &) { return true; });
+  storage->sync();
+  std::remove(Path::snapshotPath);
+
+  return 0;
+}
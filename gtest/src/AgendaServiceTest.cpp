@@ -1,11 +1,15 @@
 #define GTEST
 #include <gtest/gtest.h>
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <string>
+#include <thread>
 #include <vector>
 #include "AgendaService.hpp"
+#include "Backend.hpp"
+#include "Exception.hpp"
 #include "utility.h"
 
 using std::list;
@@ -853,3 +857,84 @@ TEST_F(AgendaServiceTest, ListMeeting) {
   EXPECT_TRUE(service->listAllSponsorMeetings(user2.getName()).empty());
   EXPECT_TRUE(service->listAllParticipateMeetings(user2.getName()).empty());
 }
+
+/*
+ *  Test createMeetings() on a storage of its own, each meeting is checked
+ *  against the stored ones and the earlier ones of the batch
+ */
+TEST_F(AgendaServiceTest, CreateMeetings) {
+  AgendaService batch(Storage::open(Backend::create("memory")));
+  for (const User &user : userSamples)
+    ASSERT_TRUE(batch.userRegister(user.getName(), user.getPassword(),
+                                   user.getEmail(), user.getPhone()));
+  ASSERT_TRUE(batch.createMeeting("Naked Snake", "I wanna Quite",
+                                  "2016-07-08/11:10", "2016-07-08/12:05",
+                                  {"Lara Croft"}));
+
+  auto results = batch.createMeetings({
+      {"Trevor", "Heist", "2016-07-08/09:00", "2016-07-08/10:00", {"Ghost"}},
+      {"Trevor", "Heist", "2016-07-08/09:00", "2016-07-08/10:00",
+       {"Lara Croft"}},
+      {"Geralt of Rivia", "Heist", "2016-07-09/09:00", "2016-07-09/10:00",
+       {"Naked Snake"}},
+      {"Geralt of Rivia", "Gwent", "2016-07-08/12:00", "2016-07-08/13:00",
+       {"Naked Snake"}},
+      {"Geralt of Rivia", "Gwent", "2016-07-08/12:05", "2016-07-08/13:00",
+       {"Naked Snake"}},
+      {"Naked Snake", "Sneak", "2016-07-08/12:30", "2016-07-08/14:00",
+       {"Trevor"}},
+      {"Naked Snake", "Sneak", "2016-07-08/09:30", "2016-07-08/09:40",
+       {"Geralt of Rivia"}},
+      {"Lara Croft", "Raid", "2016-07-08/13:00", "2016-07-08/12:00",
+       {"Trevor"}},
+      {"Lara Croft", "Raid", "2016-07-08/13:00", "2016-07-08/14:00",
+       {"Trevor", "Trevor"}},
+      {"Lara Croft", "Raid", "2016-07-08/13:00", "2016-07-08/14:00",
+       {"Trevor"}}});
+
+  const vector<string> errors = {
+      "User Not Found", "", "Title Repeat", "Time Confliction", "",
+      "Time Confliction", "", "Invalid Date", "User Repeat", ""};
+  ASSERT_EQ(errors.size(), results.size());
+  for (std::size_t i = 0; i < errors.size(); ++i) {
+    EXPECT_EQ(errors[i].empty(), results[i].created) << "i = " << i;
+    EXPECT_EQ(errors[i], results[i].error) << "i = " << i;
+  }
+  EXPECT_EQ("Sponsor: Naked Snake is busy from 2016-07-08/12:05 to "
+            "2016-07-08/13:00",
+            results[5].message);
+  EXPECT_EQ(5, batch.memoryStats().meetings);
+  EXPECT_EQ(1, batch.meetingQuery("Trevor", "Heist").size());
+  EXPECT_EQ(1, batch.meetingQuery("Trevor", "Raid").size());
+  EXPECT_TRUE(batch.meetingQuery("Trevor", "Sneak").empty());
+}
+
+/*
+ *  Test createMeeting() from many threads on a concurrent storage, the
+ *  checks and the write are atomic so only one meeting takes the time
+ */
+TEST_F(AgendaServiceTest, ConcurrentCreateMeeting) {
+  std::shared_ptr<Storage> storage = Storage::open(Backend::create("memory"));
+  storage->setConcurrent(true);
+  AgendaService shared(storage);
+  for (const User &user : userSamples)
+    ASSERT_TRUE(shared.userRegister(user.getName(), user.getPassword(),
+                                    user.getEmail(), user.getPhone()));
+
+  std::atomic<int> created(0);
+  vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&shared, &created, i]() {
+      try {
+        shared.createMeeting("Trevor", "Heist " + std::to_string(i),
+                             "2016-07-08/09:00", "2016-07-08/10:00",
+                             {"Lara Croft"});
+        ++created;
+      } catch (const time_conflict &) {
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  EXPECT_EQ(1, created);
+  EXPECT_EQ(1, shared.listAllMeetings("Trevor").size());
+}
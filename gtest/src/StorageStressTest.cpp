@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utility.h"
+
+#define private public
+#include "Storage.hpp"
+#undef private
+
+using std::list;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+using namespace utility;
+
+class StorageStressTest : public ::testing::Test {
+  //  Every test starts from the default users.csv and meetings.csv and a
+  //  fresh instance, shared by threadCount threads
+ protected:
+  static void TearDownTestCase() { recFiles(); }
+  virtual void SetUp() {
+    recFiles();
+    Storage::m_instance.reset();
+    threadCount = std::max(4u, std::thread::hardware_concurrency());
+  }
+  virtual void TearDown() { Storage::m_instance.reset(); }
+
+  static string title(int thread, int i) {
+    return "stress " + std::to_string(thread) + " " + std::to_string(i);
+  }
+  static bool isStress(const Meeting &meeting) {
+    return meeting.getTitle().compare(0, 7, "stress ") == 0;
+  }
+
+  unsigned threadCount;
+  static const int rounds = 200;
+};
+
+/*
+ *  Threads racing to create the instance all get the same one
+ */
+TEST_F(StorageStressTest, LazyInitialization) {
+  vector<Storage *> instances(threadCount);
+  vector<std::thread> threads;
+
+  for (unsigned t = 0; t < threadCount; ++t)
+    threads.emplace_back([&instances, t]() {
+      instances[t] = Storage::getInstance().get();
+    });
+
+  for (std::thread &thread : threads) thread.join();
+
+  for (Storage *instance : instances)
+    EXPECT_EQ(Storage::getInstance().get(), instance);
+}
+
+/*
+ *  Writers create, update and delete meetings while readers scan and look
+ *  them up; readers never see a half-applied mutation, and every mutation
+ *  survives
+ */
+TEST_F(StorageStressTest, ReadersAndWriters) {
+  shared_ptr<Storage> storage = Storage::getInstance();
+  storage->setConcurrent(true);
+
+  std::atomic<int> writing(threadCount / 2);
+  std::atomic<int> torn(0);
+  vector<std::thread> threads;
+
+  for (unsigned t = 0; t < threadCount / 2; ++t)
+    threads.emplace_back([&storage, &writing, t]() {
+      for (int i = 0; i < rounds; ++i) {
+        Date start(2000 + t, 1, 1 + i % 28, i / 28, 0);
+        Date end(start.getYear(), 1, start.getDay(), start.getHour(), 30);
+
+        storage->createMeeting(
+            Meeting("Lara Croft", {"Naked Snake"}, start, end, title(t, i)));
+
+        if (i % 2 == 1) storage->deleteMeetingByTitle(title(t, i - 1));
+
+        storage->updateMeetingByTitle(title(t, i), [](Meeting &meeting) {
+          meeting.setParticipator({"Geralt of Rivia"});
+        });
+
+        if (i % 50 == 0) storage->sync();
+      }
+
+      --writing;
+    });
+
+  for (unsigned t = threadCount / 2; t < threadCount; ++t)
+    threads.emplace_back([&storage, &writing, &torn]() {
+      while (writing > 0) {
+        list<Meeting> meetings =
+            storage->queryMeeting("Lara Croft", StorageStressTest::isStress);
+
+        for (const Meeting &meeting : meetings) {
+          if (meeting.getSponsor() != "Lara Croft") ++torn;
+        }
+
+        storage->forEachMeeting("Naked Snake", [&torn](const Meeting &m) {
+          if (isStress(m) && !m.isParticipator("Naked Snake")) ++torn;
+        });
+        storage->countMeetings(StorageStressTest::isStress);
+
+        //  a pinned version holds still while the writers go on
+        shared_ptr<const Version> version = storage->pinVersion();
+        int stress = version->queryMeeting(isStress).size();
+        if (version->queryMeeting(isStress).size() != stress) ++torn;
+
+        if (!storage->userExists("Lara Croft")) ++torn;
+      }
+    });
+
+  for (std::thread &thread : threads) thread.join();
+
+  EXPECT_EQ(0, torn);
+  EXPECT_EQ(int(threadCount / 2 * rounds / 2),
+            storage->countMeetings([](const Meeting &meeting) {
+              return isStress(meeting) &&
+                     meeting.isParticipator("Geralt of Rivia");
+            }));
+  EXPECT_EQ(0, storage->countMeetings("Naked Snake", isStress));
+  EXPECT_TRUE(storage->sync());
+
+  //  the synced journal brings every meeting back
+  storage.reset();
+  Storage::m_instance.reset();
+  storage = Storage::getInstance();
+  EXPECT_EQ(int(threadCount / 2 * rounds / 2),
+            storage->countMeetings(isStress));
+}
+
+/*
+ *  Writers wait for their own meetings to be on disk while the flusher
+ *  commits for them, and nothing is lost
+ */
+TEST_F(StorageStressTest, GroupCommit) {
+  shared_ptr<Storage> storage = Storage::getInstance();
+  storage->startFlusher(std::chrono::milliseconds(1), 64);
+
+  //  few enough records for the journal to stay short of a checkpoint
+  const int perThread = 2048 / threadCount;
+  std::atomic<int> failed(0);
+  vector<std::thread> threads;
+
+  for (unsigned t = 0; t < threadCount; ++t)
+    threads.emplace_back([&storage, &failed, t, perThread]() {
+      for (int i = 0; i < perThread; ++i) {
+        Date start(2000 + t, 1, 1 + i % 28, i / 28, 0);
+        Date end(start.getYear(), 1, start.getDay(), start.getHour(), 30);
+
+        storage->createMeeting(
+            Meeting("Lara Croft", {"Naked Snake"}, start, end, title(t, i)));
+
+        if (i % 10 == 0 && !storage->flush()) ++failed;
+      }
+    });
+
+  for (std::thread &thread : threads) thread.join();
+
+  EXPECT_EQ(0, failed);
+  EXPECT_TRUE(storage->flush());
+
+  //  the journal alone brings every meeting back
+  std::ifstream journalStream(journalPath);
+  string line;
+  int logged = 0;
+
+  while (std::getline(journalStream, line))
+    logged += line.rfind("M+ \"Lara Croft\"", 0) == 0;
+
+  EXPECT_EQ(int(threadCount * perThread), logged);
+  storage->stopFlusher();
+}
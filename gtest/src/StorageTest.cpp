@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 #include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -7,7 +12,9 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
+#include "Exception.hpp"
 #include "utility.h"
 
 #define TESTWRITETOFILE
@@ -23,6 +30,8 @@
 #undef private
 #endif
 
+#include "Tenants.hpp"
+
 using std::function;
 using std::list;
 using std::shared_ptr;
@@ -203,8 +212,419 @@ TEST_F(StorageTest, MeetingOperation) {
   utility::testMeetingList(simMeetingList, meetingList);
 }
 
+/*
+ *  Test the username index kept by create/update/delete
+ */
+TEST_F(StorageTest, UserIndex) {
+  ASSERT_NE(nullptr, storage->findUserByName(user1.getName()));
+  EXPECT_TRUE(judgeUserEqual(user1, *storage->findUserByName(user1.getName())));
+  EXPECT_FALSE(storage->userExists(user4.getName()));
+  storage->createUser(user4);
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  //  Rename through updateUser
+  storage->updateUser(
+      [&](const User &user) { return user.getName() == user4.getName(); },
+      [](User &user) { user.setName("Trevor Philips"); });
+  EXPECT_FALSE(storage->userExists(user4.getName()));
+  ASSERT_NE(nullptr, storage->findUserByName("Trevor Philips"));
+  EXPECT_EQ(user4.getPassword(),
+            storage->findUserByName("Trevor Philips")->getPassword());
+  //  Delete
+  storage->deleteUser(
+      [](const User &user) { return user.getName() == "Trevor Philips"; });
+  EXPECT_EQ(nullptr, storage->findUserByName("Trevor Philips"));
+}
+
+/*
+ *  Test the per-user meeting posting lists
+ */
+TEST_F(StorageTest, MeetingPostings) {
+  //  Lara Croft takes part in meeting1 and meeting2
+  list<Meeting> meetingList =
+      storage->queryMeeting(user1.getName(), getAllMeeting);
+  utility::testMeetingList(simMeetingList, meetingList);
+  EXPECT_TRUE(storage->queryMeeting(user4.getName(), getAllMeeting).empty());
+  //  Lara Croft sponsors meeting3
+  storage->createMeeting(meeting3);
+  simMeetingList.push_back(meeting3);
+  meetingList = storage->queryMeeting(user1.getName(), getAllMeeting);
+  utility::testMeetingList(simMeetingList, meetingList);
+  //  Move meeting3 to another participator, meeting2 is visited untouched
+  EXPECT_EQ(2, storage->updateMeeting(
+                   user2.getName(), getAllMeeting, [&](Meeting &meeting) {
+                     if (meeting.getTitle() == meeting3.getTitle())
+                       meeting.setParticipator({user4.getName()});
+                   }));
+  EXPECT_EQ(1, storage->queryMeeting(user2.getName(), getAllMeeting).size());
+  EXPECT_EQ(1, storage->queryMeeting(user4.getName(), getAllMeeting).size());
+  //  Delete through the posting list
+  EXPECT_EQ(2, storage->deleteMeeting(user3.getName(), getAllMeeting));
+  meetingList = storage->queryMeeting(user1.getName(), getAllMeeting);
+  ASSERT_EQ(1, meetingList.size());
+  EXPECT_EQ(meeting3.getTitle(), meetingList.front().getTitle());
+}
+
+/*
+ *  Test the per-user schedule used for time conflicts
+ */
+TEST_F(StorageTest, TimeConflict) {
+  Date start = Date::stringToDate("2016-07-10/17:00");
+  Date end = Date::stringToDate("2016-07-10/19:00");
+  //  meeting2 runs from 15:00 to 18:00
+  const Meeting *conflict =
+      storage->findTimeConflict(user1.getName(), start, end);
+  ASSERT_NE(nullptr, conflict);
+  EXPECT_EQ(meeting2.getTitle(), conflict->getTitle());
+  EXPECT_EQ(nullptr, storage->findTimeConflict(user4.getName(), start, end));
+  //  Touching intervals do not overlap
+  EXPECT_EQ(nullptr,
+            storage->findTimeConflict(user2.getName(), meeting2.getEndDate(),
+                                      end));
+  //  Moving the meeting moves the schedule too
+  storage->updateMeeting(
+      [&](const Meeting &meeting) {
+        return meeting.getTitle() == meeting2.getTitle();
+      },
+      [](Meeting &meeting) {
+        meeting.setStartDate(Date::stringToDate("2016-07-10/12:00"));
+        meeting.setEndDate(Date::stringToDate("2016-07-10/13:00"));
+      });
+  EXPECT_EQ(nullptr, storage->findTimeConflict(user1.getName(), start, end));
+  EXPECT_NE(nullptr,
+            storage->findTimeConflict(
+                user3.getName(), Date::stringToDate("2016-07-10/12:30"), end));
+}
+
+/*
+ *  Test the title index and the title keyed operations
+ */
+TEST_F(StorageTest, TimeWindow) {
+  storage->createMeeting(meeting3);
+  //  Every meeting touching the window, in the order of their start dates
+  list<Meeting> meetingList =
+      storage->queryMeeting(Date::stringToDate("2016-07-08/12:05"),
+                            Date::stringToDate("2016-07-11/17:21"));
+  ASSERT_EQ(3, meetingList.size());
+  EXPECT_EQ(meeting1.getTitle(), meetingList.front().getTitle());
+  EXPECT_EQ(meeting3.getTitle(), meetingList.back().getTitle());
+  EXPECT_TRUE(storage
+                  ->queryMeeting(Date::stringToDate("2016-07-08/12:06"),
+                                 Date::stringToDate("2016-07-10/14:59"))
+                  .empty());
+  //  The meetings of one user only
+  meetingList = storage->queryMeeting(user2.getName(),
+                                      Date::stringToDate("2016-07-01/00:00"),
+                                      Date::stringToDate("2016-07-31/00:00"));
+  ASSERT_EQ(2, meetingList.size());
+  EXPECT_EQ(meeting2.getTitle(), meetingList.front().getTitle());
+  EXPECT_EQ(meeting3.getTitle(), meetingList.back().getTitle());
+  //  A meeting moved in time moves in the index too
+  storage->updateMeetingByTitle(meeting3.getTitle(), [](Meeting &m) {
+    m.setStartDate(Date::stringToDate("2016-07-01/08:00"));
+    m.setEndDate(Date::stringToDate("2016-07-01/09:00"));
+  });
+  meetingList = storage->queryMeeting(user2.getName(),
+                                      Date::stringToDate("2016-07-01/00:00"),
+                                      Date::stringToDate("2016-07-31/00:00"));
+  ASSERT_EQ(2, meetingList.size());
+  EXPECT_EQ(meeting3.getTitle(), meetingList.front().getTitle());
+  EXPECT_TRUE(storage
+                  ->queryMeeting(user4.getName(),
+                                 Date::stringToDate("2016-07-01/00:00"),
+                                 Date::stringToDate("2016-07-31/00:00"))
+                  .empty());
+}
+
+TEST_F(StorageTest, TitleIndex) {
+  const Meeting *meeting = storage->findMeetingByTitle(meeting2.getTitle());
+  ASSERT_NE(nullptr, meeting);
+  EXPECT_TRUE(judgeMeetingEqual(meeting2, *meeting));
+  EXPECT_EQ(nullptr, storage->findMeetingByTitle(meeting3.getTitle()));
+  //  Update by title, including a rename
+  EXPECT_EQ(1, storage->updateMeetingByTitle(
+                   meeting2.getTitle(),
+                   [](Meeting &meeting) { meeting.setTitle("Gwent"); }));
+  EXPECT_EQ(nullptr, storage->findMeetingByTitle(meeting2.getTitle()));
+  ASSERT_NE(nullptr, storage->findMeetingByTitle("Gwent"));
+  EXPECT_EQ(0, storage->updateMeetingByTitle(meeting3.getTitle(),
+                                             [](Meeting &) {}));
+  //  Delete by title
+  EXPECT_EQ(1, storage->deleteMeetingByTitle("Gwent"));
+  EXPECT_EQ(0, storage->deleteMeetingByTitle("Gwent"));
+  EXPECT_EQ(1, storage->queryMeeting(getAllMeeting).size());
+}
+
+/*
+ *  Test that compaction keeps queries and indexes intact
+ */
+TEST_F(StorageTest, Compaction) {
+  storage->createUser(user4);
+  storage->createMeeting(meeting3);
+  storage->deleteUser(
+      [&](const User &user) { return user.getName() == user2.getName(); });
+  storage->deleteMeeting([&](const Meeting &meeting) {
+    return meeting.getTitle() == meeting1.getTitle();
+  });
+  storage->compact();
+  simUserList = {user1, user3, user4};
+  simMeetingList = {meeting2, meeting3};
+  utility::testUserList(simUserList, storage->queryUser(getAllUser));
+  utility::testMeetingList(simMeetingList,
+                           storage->queryMeeting(getAllMeeting));
+  EXPECT_FALSE(storage->userExists(user2.getName()));
+  ASSERT_NE(nullptr, storage->findUserByName(user4.getName()));
+  EXPECT_EQ(user4.getEmail(),
+            storage->findUserByName(user4.getName())->getEmail());
+  ASSERT_NE(nullptr, storage->findMeetingByTitle(meeting3.getTitle()));
+  EXPECT_EQ(2, storage->queryMeeting(user1.getName(), getAllMeeting).size());
+  EXPECT_NE(nullptr, storage->findTimeConflict(user1.getName(),
+                                               meeting3.getStartDate(),
+                                               meeting3.getEndDate()));
+}
+
+/*
+ *  The visitors see the stored records, and the early-exit scans stop at the
+ *  first fitted one
+ */
+TEST_F(StorageTest, Visitors) {
+  int visited = 0;
+  storage->forEachUser([&visited](const User &) { ++visited; });
+  EXPECT_EQ(3, visited);
+
+  visited = 0;
+  EXPECT_TRUE(storage->anyUser([&visited](const User &) {
+    ++visited;
+    return true;
+  }));
+  EXPECT_EQ(1, visited);
+  EXPECT_FALSE(storage->anyMeeting(
+      [](const Meeting &meeting) { return meeting.getTitle() == "none"; }));
+
+  const Meeting *first = storage->firstMeeting([](const Meeting &meeting) {
+    return meeting.isParticipator("Lara Croft");
+  });
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(meeting1.getTitle(), first->getTitle());
+  EXPECT_EQ(2, storage->countMeetings([](const Meeting &meeting) {
+    return meeting.isParticipator("Lara Croft");
+  }));
+
+  const string snake = user3.getName();
+  visited = 0;
+  storage->forEachMeeting(snake, [&visited](const Meeting &) { ++visited; });
+  EXPECT_EQ(2, visited);
+  EXPECT_EQ(1, storage->countMeetings(snake, [&snake](const Meeting &m) {
+    return m.getSponsor() == snake;
+  }));
+  first = storage->firstMeeting(snake, [&snake](const Meeting &m) {
+    return m.isParticipator(snake);
+  });
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(meeting2.getTitle(), first->getTitle());
+  EXPECT_FALSE(
+      storage->anyMeeting("nobody", [](const Meeting &) { return true; }));
+}
+
+/*
+ *  std::function filters and switchers still work through the overloads that
+ *  forward to the templates
+ */
+TEST_F(StorageTest, FunctionOverloads) {
+  std::function<bool(const Meeting &)> lara = [](const Meeting &meeting) {
+    return meeting.isParticipator("Lara Croft");
+  };
+  std::function<void(Meeting &)> rename = [](Meeting &meeting) {
+    meeting.setTitle(meeting.getTitle() + "!");
+  };
+
+  EXPECT_EQ(2u, storage->queryMeeting(lara).size());
+  EXPECT_EQ(2, storage->countMeetings(lara));
+  EXPECT_EQ(2, storage->countMeetings(user3.getName(), lara));
+  EXPECT_EQ(2, storage->updateMeeting(lara, rename));
+  EXPECT_NE(nullptr, storage->findMeetingByTitle(meeting1.getTitle() + "!"));
+  EXPECT_EQ(2, storage->deleteMeeting(lara));
+  EXPECT_FALSE(storage->anyMeeting(lara));
+  EXPECT_EQ(3u, storage->queryUser(getAllUser).size());
+}
+
+/*
+ *  A pinned version keeps its view while the tables change, and the next
+ *  version shares the chunks that were not written
+ */
+TEST_F(StorageTest, VersionPinning) {
+  std::shared_ptr<const Version> before = storage->pinVersion();
+  EXPECT_EQ(before, storage->pinVersion());
+  EXPECT_EQ(3u, before->userCount());
+
+  storage->createMeeting(meeting3);
+  storage->deleteMeetingByTitle(meeting1.getTitle());
+  std::shared_ptr<const Version> after = storage->pinVersion();
+
+  EXPECT_LT(before->number(), after->number());
+  utility::testMeetingList({meeting1, meeting2},
+                           before->queryMeeting(getAllMeeting));
+  utility::testMeetingList({meeting2, meeting3},
+                           after->queryMeeting(getAllMeeting));
+  EXPECT_EQ(1u, after->queryMeeting("Naked Snake", getAllMeeting).size());
+  EXPECT_EQ(before->m_users[0], after->m_users[0]);
+  EXPECT_NE(before->m_meetings[0], after->m_meetings[0]);
+}
+
+/*
+ *  A transaction that throws leaves the tables as they were before it
+ */
+TEST_F(StorageTest, TransactionRollback) {
+  try {
+    storage->transaction([this]() {
+      storage->createUser(user4);
+      storage->updateUser(getAllUser, [](User &user) { user.setPhone("0"); });
+      storage->deleteUser([](const User &user) {
+        return user.getName() == user1.getName();
+      });
+      storage->createMeeting(meeting3);
+      storage->deleteMeetingByTitle(meeting1.getTitle());
+      storage->updateMeetingByTitle(meeting2.getTitle(), [](Meeting &m) {
+        m.addParticipator("Trevor");
+      });
+      throw time_conflict("rolled back");
+    });
+    FAIL() << "time_conflict expected";
+  } catch (const time_conflict &) {
+  }
+
+  utility::testUserList({user1, user2, user3}, storage->queryUser(getAllUser));
+  utility::testMeetingList({meeting1, meeting2},
+                           storage->queryMeeting(getAllMeeting));
+  EXPECT_EQ(nullptr, storage->findUserByName(user4.getName()));
+  EXPECT_NE(nullptr, storage->findUserByName(user1.getName()));
+  EXPECT_EQ(2, storage->countMeetings(user3.getName(), getAllMeeting));
+
+  storage->transaction([this]() {
+    storage->transaction([this]() { storage->createUser(user4); });
+  });
+  EXPECT_NE(nullptr, storage->findUserByName(user4.getName()));
+}
+
 #ifdef TESTWRITETOFILE
 
+TEST_F(StorageTest, SymbolInterning) {
+  //  The same name always gives the same id
+  const Symbols::Id lara = Symbols::intern(user1.getName());
+  EXPECT_EQ(lara, Symbols::intern(user1.getName()));
+  Symbols::release(lara);
+  Symbols::release(lara);
+  EXPECT_EQ(lara, Symbols::find(user1.getName()));
+  EXPECT_EQ(user1.getName(), Symbols::name(lara));
+  EXPECT_EQ(Symbols::empty, Symbols::find(""));
+  EXPECT_EQ(Symbols::none, Symbols::find("Nobody Interned"));
+  //  Meetings keep ids and hand the names back
+  EXPECT_EQ(lara, meeting3.getSponsorId());
+  EXPECT_EQ(user1.getName(), meeting3.getSponsor());
+  EXPECT_TRUE(meeting1.isParticipator(lara));
+  EXPECT_FALSE(meeting1.isParticipator(Symbols::none));
+  EXPECT_EQ(vector<string>({"Naked Snake", "Lara Croft"}),
+            meeting2.getParticipator());
+  //  A name interned after the indexes were built grows them on demand
+  Meeting meeting(meeting3);
+  meeting.setParticipator({"Interned Late"});
+  storage->createMeeting(meeting);
+  EXPECT_EQ(1, storage->countMeetings("Interned Late", getAllMeeting));
+  EXPECT_TRUE(storage->queryMeeting("Nobody Interned", getAllMeeting).empty());
+  //  A name goes with the last meeting holding it, and its id is reused
+  storage->deleteMeetingByTitle(meeting.getTitle());
+  {
+    Meeting copy(meeting);
+    meeting.removeParticipator("Interned Late");
+    EXPECT_FALSE(meeting.isParticipator("Interned Late"));
+    EXPECT_NE(Symbols::none, Symbols::find("Interned Late"));
+  }
+  EXPECT_EQ(Symbols::none, Symbols::find("Interned Late"));
+  const Symbols::Id late = Symbols::intern("Interned Again");
+  EXPECT_EQ(late, Symbols::find("Interned Again"));
+  Symbols::release(late);
+}
+
+TEST_F(StorageTest, UsernameFilter) {
+  //  Missing names are answered by the filter, rarely by the index
+  const Storage::FilterStats before = storage->filterStats();
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_FALSE(storage->userExists("Ghost " + std::to_string(i)));
+    EXPECT_EQ(nullptr, storage->findUserByName("Ghost " + std::to_string(i)));
+  }
+  const Storage::FilterStats after = storage->filterStats();
+  EXPECT_EQ(2000, after.lookups - before.lookups);
+  EXPECT_EQ(2000, after.rejections + after.falsePositives -
+                      before.rejections - before.falsePositives);
+  EXPECT_LT(after.observedRate, 0.05);
+  EXPECT_LT(after.expectedRate, 0.05);
+  //  The filter grows with the users and never hides one
+  for (int i = 0; i < 3000; ++i)
+    storage->createUser(User("Member " + std::to_string(i), "", "", ""));
+  EXPECT_GE(storage->m_userFilter.capacity(), 3003);
+  for (int i = 0; i < 3000; ++i)
+    EXPECT_TRUE(storage->userExists("Member " + std::to_string(i)));
+  //  and shrinks once the deleted names outnumber the live ones
+  storage->deleteUser([](const User &user) {
+    return user.getName().compare(0, 7, "Member ") == 0;
+  });
+  EXPECT_LT(storage->m_userFilter.keys(), 3000);
+  EXPECT_FALSE(storage->userExists("Member 0"));
+  for (const User &user : simUserList)
+    EXPECT_TRUE(storage->userExists(user.getName()));
+}
+
+/*
+ *  The memory report adds up, and the meeting components grow with the
+ *  meetings
+ */
+TEST_F(StorageTest, MemoryStats) {
+  const Storage::MemoryStats before = storage->memoryStats();
+  EXPECT_EQ(3, before.users);
+  EXPECT_EQ(2, before.meetings);
+  EXPECT_EQ(before.userRecords + before.meetingRecords + before.userStrings +
+                before.titleStrings + before.participators +
+                before.userIndex + before.userFilter + before.titleIndex +
+                before.meetingIndex + before.scheduleIndex +
+                before.calendarIndex + before.version + before.backend,
+            before.total());
+  EXPECT_GT(Symbols::bytes(), 0);
+  for (int i = 0; i < 1000; ++i) {
+    const int month = 1 + i / 672, day = 1 + i / 24 % 28, hour = i % 24;
+    storage->createMeeting(
+        Meeting("Lara Croft", vector<string>({"Naked Snake"}),
+                Date(2020, month, day, hour, 0),
+                Date(2020, month, day, hour, 30),
+                "A meeting whose title is too long to fit inline " +
+                    std::to_string(i)));
+  }
+  const Storage::MemoryStats after = storage->memoryStats();
+  EXPECT_EQ(1002, after.meetings);
+  EXPECT_GT(after.meetingRecords, before.meetingRecords);
+  EXPECT_GE(after.titleStrings - before.titleStrings, 1000 * 50);
+  EXPECT_GT(after.participators, before.participators);
+  EXPECT_GT(after.titleIndex, before.titleIndex);
+  EXPECT_GT(after.calendarIndex, before.calendarIndex);
+  EXPECT_GT(after.meetingBytes(), before.meetingBytes());
+  EXPECT_LE(after.meetingBytes(), after.total());
+  EXPECT_EQ(before.userRecords, after.userRecords);
+
+  // the names other storages interned cost this one nothing
+  const std::size_t names = Symbols::size();
+  vector<Symbols::Id> elsewhere;
+  for (int i = 0; i < 100000; ++i)
+    elsewhere.push_back(Symbols::intern("Someone Else " + std::to_string(i)));
+  shared_ptr<Storage> small = Storage::open(Backend::create("memory"));
+  small->createMeeting(Meeting("Someone Else 99999",
+                               vector<string>({"Someone Else 0"}),
+                               Date(2020, 1, 1, 0, 0), Date(2020, 1, 1, 1, 0),
+                               "Elsewhere"));
+  const Storage::MemoryStats smallStats = small->memoryStats();
+  EXPECT_LT(smallStats.meetingIndex + smallStats.scheduleIndex, 1024);
+  for (Symbols::Id id : elsewhere) Symbols::release(id);
+  small.reset();
+  EXPECT_EQ(names, Symbols::size());
+}
+
 class StoragePrivateTest : public StorageTest {
  public:
   virtual void TearDown() { recFiles(); }
@@ -226,6 +646,603 @@ class StoragePrivateTest : public StorageTest {
 //     storage.reset();
 // }
 
+/*
+ *  A malformed line is reported with its line number
+ */
+TEST_F(StoragePrivateTest, WrongFormatLine) {
+  storage->m_instance.reset();
+  storage.reset();
+  std::ofstream meetingStream(meetingPath, std::ofstream::app);
+  meetingStream << R"("Naked Snake","Lara Croft","2016-07-08/11:10")" << '\n';
+  meetingStream.close();
+  try {
+    Storage::getInstance();
+    FAIL() << "wrong_format expected";
+  } catch (const wrong_format &e) {
+    EXPECT_NE(string::npos, e.what().find("line 3")) << e.what();
+  }
+}
+
+/*
+ *  A file longer than a chunk loads in file order, and a bad line in a later
+ *  chunk is reported with its line number in the whole file
+ */
+TEST_F(StoragePrivateTest, ChunkedLoad) {
+  storage->m_instance.reset();
+  storage.reset();
+  //  about 2MB of users after the 3 in the file, so the file spans 3 chunks
+  std::ofstream userStream(userPath, std::ofstream::app);
+  for (int i = 0; i < 40000; ++i)
+    userStream << "\"user" << i
+               << R"(","password","user@email.com","13800000000")" << '\n';
+  userStream.close();
+
+  storage = Storage::getInstance();
+  list<User> users = storage->queryUser(getAllUser);
+  ASSERT_EQ(40003, users.size());
+  EXPECT_EQ(user1.getName(), users.front().getName());
+  EXPECT_EQ("user39999", users.back().getName());
+  EXPECT_EQ(2, storage->queryMeeting(getAllMeeting).size());
+  storage->m_instance.reset();
+  storage.reset();
+
+  recFiles();
+  userStream.open(userPath, std::ofstream::app);
+  for (int i = 0; i < 40000; ++i)
+    userStream << "\"user" << i << R"(","password","user@email.com",")"
+               << (i == 39000 ? "" : "13800000000") << "\"\n";
+  userStream.close();
+  try {
+    Storage::getInstance();
+    FAIL() << "wrong_format expected";
+  } catch (const wrong_format &e) {
+    EXPECT_NE(string::npos, e.what().find("line 39004 of")) << e.what();
+  }
+}
+
+/*
+ *  Sync appends the mutations to the journal instead of rewriting the files,
+ *  the next instance replays them and drops a torn last record
+ */
+TEST_F(StoragePrivateTest, JournalReplay) {
+  storage->createUser(user4);
+  storage->updateMeetingByTitle(meeting1.getTitle(), [](Meeting &meeting) {
+    meeting.addParticipator("Trevor");
+  });
+  storage->deleteMeetingByTitle(meeting2.getTitle());
+  ASSERT_TRUE(storage->sync());
+  storage->m_instance.reset();
+  storage.reset();
+
+  std::ifstream userStream(userPath);
+  EXPECT_EQ(3, std::count(std::istreambuf_iterator<char>(userStream),
+                          std::istreambuf_iterator<char>(), '\n'));
+  std::ofstream journalStream(journalPath, std::ofstream::app);
+  journalStream << R"(U+ "Half a record")";
+  journalStream.close();
+
+  storage = Storage::getInstance();
+  EXPECT_NE(nullptr, storage->findUserByName(user4.getName()));
+  EXPECT_FALSE(storage->userExists("Half a record"));
+  const Meeting *meeting = storage->findMeetingByTitle(meeting1.getTitle());
+  ASSERT_NE(nullptr, meeting);
+  EXPECT_TRUE(meeting->isParticipator("Trevor"));
+  EXPECT_EQ(nullptr, storage->findMeetingByTitle(meeting2.getTitle()));
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A transaction is journaled as one group, the next instance replays a
+ *  whole group and drops one cut short
+ */
+TEST_F(StoragePrivateTest, TransactionJournal) {
+  storage->transaction([this]() {
+    storage->createUser(user4);
+    storage->deleteMeetingByTitle(meeting2.getTitle());
+  });
+  ASSERT_TRUE(storage->sync());
+  storage->m_instance.reset();
+  storage.reset();
+
+  std::ofstream journalStream(journalPath, std::ofstream::app);
+  journalStream << "T 2\n" << R"(U- "Naked Snake")" << '\n';
+  journalStream.close();
+
+  storage = Storage::getInstance();
+  EXPECT_NE(nullptr, storage->findUserByName(user4.getName()));
+  EXPECT_EQ(nullptr, storage->findMeetingByTitle(meeting2.getTitle()));
+  EXPECT_TRUE(storage->userExists("Naked Snake"));
+  storage->m_instance.reset();
+  storage.reset();
+
+  //  a group header that does not parse is a bad record
+  journalStream.open(journalPath, std::ofstream::app);
+  journalStream << "T 99999999999999999999999\n";
+  journalStream.close();
+  EXPECT_THROW(Storage::getInstance(), wrong_format);
+}
+
+/*
+ *  A backend whose journal writes fail until told otherwise
+ */
+class FailingBackend : public MemoryBackend {
+ public:
+  virtual void append(const string &t_record) {
+    this->buffer += t_record + '\n';
+  }
+  virtual string takeChanges(void) {
+    string records;
+    records.swap(this->buffer);
+    return records;
+  }
+  virtual bool writeChanges(const string &t_records, bool) const {
+    if (this->failing) return false;
+    this->written += t_records;
+    return true;
+  }
+  virtual void restoreChanges(const string &t_records) {
+    this->buffer.insert(0, t_records);
+  }
+
+  bool failing = true;
+  string buffer;
+  mutable string written;
+};
+
+/*
+ *  The records a failed commit could not write are kept, and the next
+ *  commit writes them before the later ones
+ */
+TEST_F(StoragePrivateTest, FailedCommit) {
+  auto *backend = new FailingBackend;
+  shared_ptr<Storage> failing =
+      Storage::open(std::unique_ptr<Backend>(backend));
+  failing->createUser(user4);
+  EXPECT_FALSE(failing->sync());
+  EXPECT_TRUE(failing->m_dirty);
+  failing->createUser(user1);
+  backend->failing = false;
+  EXPECT_TRUE(failing->sync());
+  EXPECT_LT(backend->written.find(user4.getName()),
+            backend->written.find(user1.getName()));
+  EXPECT_NE(string::npos, backend->written.find(user1.getName()));
+  EXPECT_TRUE(backend->buffer.empty());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A commit cut short partway leaves no part of its records in the journal,
+ *  so the retry writes them whole and the next start replays them
+ */
+TEST_F(StoragePrivateTest, TornCommit) {
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->sync());
+
+  // a file size limit stands in for a full disk, the write stops partway
+  struct stat before, after;
+  struct rlimit unlimited, limited;
+  ASSERT_EQ(0, stat(journalPath, &before));
+  getrlimit(RLIMIT_FSIZE, &unlimited);
+  limited = unlimited;
+  limited.rlim_cur = before.st_size + 8;
+  auto handler = signal(SIGXFSZ, SIG_IGN);
+  setrlimit(RLIMIT_FSIZE, &limited);
+  storage->transaction([this]() {
+    storage->deleteMeetingByTitle(meeting1.getTitle());
+    storage->deleteMeetingByTitle(meeting2.getTitle());
+  });
+  EXPECT_FALSE(storage->sync());
+  setrlimit(RLIMIT_FSIZE, &unlimited);
+  signal(SIGXFSZ, handler);
+  ASSERT_EQ(0, stat(journalPath, &after));
+  EXPECT_EQ(before.st_size, after.st_size);
+
+  EXPECT_TRUE(storage->sync());
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  EXPECT_TRUE(storage->queryMeeting(getAllMeeting).empty());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  The flusher writes the journal in the background, and flush() waits for
+ *  the records to reach the file
+ */
+TEST_F(StoragePrivateTest, BackgroundFlusher) {
+  auto journalText = []() {
+    std::ifstream journalStream(journalPath);
+
+    return string(std::istreambuf_iterator<char>(journalStream),
+                  std::istreambuf_iterator<char>());
+  };
+
+  storage->startFlusher(std::chrono::milliseconds(10000), 2);
+  storage->createUser(user4);
+  EXPECT_TRUE(storage->flush());
+  EXPECT_NE(string::npos, journalText().find(user4.getName()));
+
+  // the second waiting record wakes the flusher before the interval ends
+  storage->deleteMeetingByTitle(meeting1.getTitle());
+  storage->deleteMeetingByTitle(meeting2.getTitle());
+  for (int i = 0; i < 1000 && journalText().find("M- ") == string::npos; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_NE(string::npos, journalText().find(meeting2.getTitle()));
+
+  // stopping commits what is left
+  storage->createMeeting(meeting3);
+  storage->stopFlusher();
+  EXPECT_NE(string::npos, journalText().find(meeting3.getTitle()));
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A journal is thrown away once the files it was started for are replaced
+ */
+TEST_F(StoragePrivateTest, StaleJournal) {
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->sync());
+  storage->m_instance.reset();
+  storage.reset();
+  std::ofstream userStream(userPath, std::ofstream::app);
+  userStream << R"("Trevor","Edited","by@hand.com","13500000000")" << '\n';
+  userStream.close();
+
+  storage = Storage::getInstance();
+  const User *user = storage->findUserByName(user4.getName());
+  ASSERT_NE(nullptr, user);
+  EXPECT_EQ("Edited", user->getPassword());
+  EXPECT_EQ(4, storage->queryUser(getAllUser).size());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A journal belongs to the generation of its partitions, not to their
+ *  modification times, so a copied data directory keeps it. A journal of
+ *  files neither current nor older is refused instead of dropped
+ */
+TEST_F(StoragePrivateTest, JournalStamp) {
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->checkpoint());
+  storage->m_instance.reset();
+  storage.reset();
+  std::ofstream(journalPath, std::ofstream::app)
+      << R"(U+ "Franklin","Clinton","f@email.com","13400000000")" << '\n';
+  for (int partition = 0; partition < Path::partitions; ++partition)
+    std::filesystem::last_write_time(
+        partitionPath(Path::userPath, partition),
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->userExists("Franklin"));
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  ASSERT_TRUE(storage->checkpoint());
+  storage->m_instance.reset();
+  storage.reset();
+
+  std::ofstream(journalPath, std::ofstream::trunc)
+      << "#generation 999999\n"
+      << R"(U- "Franklin")" << '\n';
+  EXPECT_THROW(Storage::getInstance(), wrong_format);
+  std::ifstream journalStream(journalPath);
+  EXPECT_EQ(2, std::count(std::istreambuf_iterator<char>(journalStream),
+                          std::istreambuf_iterator<char>(), '\n'));
+}
+
+/*
+ *  A snapshot whose manifest was committed is moved into place on the next
+ *  start, the files of an uncommitted one are removed
+ */
+TEST_F(StoragePrivateTest, InterruptedSnapshot) {
+  storage->m_instance.reset();
+  storage.reset();
+  std::remove(userPath);
+  std::remove(meetingPath);
+  for (int partition = 0; partition < Path::partitions; ++partition) {
+    std::remove(partitionPath(Path::userPath, partition).c_str());
+    std::remove(partitionPath(Path::meetingPath, partition).c_str());
+  }
+  mkdir(Path::userPath, 0755);
+  const string user = R"("Trevor","GrandTheftAutoV","Trevor@email.com","1")";
+  const string trevorPath =
+      partitionPath(Path::userPath, Storage::partitionOf("Trevor"));
+  std::ofstream(trevorPath + ".100.tmp") << user << '\n';
+  std::ofstream(trevorPath + ".101.tmp") << "half";
+  std::ofstream(Path::manifestPath)
+      << "100\nwrite users/" << Storage::partitionOf("Trevor") << ".csv "
+      << user.size() + 1 << "\n";
+
+  storage = Storage::getInstance();
+  EXPECT_EQ(1, storage->queryUser(getAllUser).size());
+  EXPECT_TRUE(storage->userExists("Trevor"));
+  EXPECT_TRUE(storage->queryMeeting(getAllMeeting).empty());
+  EXPECT_FALSE(std::ifstream(trevorPath + ".100.tmp").is_open());
+  EXPECT_FALSE(std::ifstream(trevorPath + ".101.tmp").is_open());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A checkpoint whose files cannot all be moved into place fails, but its
+ *  manifest is committed: the journal starts over on it, and the next start
+ *  moves the files and replays what was logged since
+ */
+TEST_F(StoragePrivateTest, FailedRename) {
+  const string trevorPath =
+      partitionPath(Path::userPath, Storage::partitionOf("Trevor"));
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->sync());
+  std::remove(trevorPath.c_str());
+  mkdir(Path::userPath, 0755);
+  mkdir(trevorPath.c_str(), 0755);
+  mkdir((trevorPath + "/in the way").c_str(), 0755);
+  EXPECT_FALSE(storage->checkpoint());
+
+  storage->deleteMeetingByTitle(meeting1.getTitle());
+  ASSERT_TRUE(storage->sync());
+  std::filesystem::remove_all(trevorPath);
+
+  // no checkpoint on the way out, as after a crash
+  storage->m_dirty = false;
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  EXPECT_EQ(4, storage->queryUser(getAllUser).size());
+  EXPECT_EQ(nullptr, storage->findMeetingByTitle(meeting1.getTitle()));
+  EXPECT_EQ(1, storage->queryMeeting(getAllMeeting).size());
+  EXPECT_TRUE(storage->checkpoint());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  A checkpoint rewrites only the partitions that changed, and the files
+ *  imported from are dropped once every partition holds their records
+ */
+TEST_F(StoragePrivateTest, Partitions) {
+  storage->createUser(user4);
+  storage->m_instance.reset();
+  storage.reset();
+  EXPECT_FALSE(std::ifstream(userPath).is_open());
+  EXPECT_FALSE(std::ifstream(meetingPath).is_open());
+
+  storage = Storage::getInstance();
+  storage->updateUser(
+      [](const User &user) { return user.getName() == "Trevor"; },
+      [](User &user) { user.setPhone("0"); });
+  storage->m_instance.reset();
+  storage.reset();
+
+  std::ifstream manifest(Path::manifestPath);
+  vector<string> lines;
+  for (string line; std::getline(manifest, line);) lines.push_back(line);
+  ASSERT_EQ(2u, lines.size());
+  const string trevorName =
+      "users/" + std::to_string(Storage::partitionOf("Trevor")) + ".csv";
+  EXPECT_EQ("write " + trevorName + " ",
+            lines[1].substr(0, trevorName.size() + 7));
+
+  storage = Storage::getInstance();
+  EXPECT_EQ(4, storage->queryUser(getAllUser).size());
+  EXPECT_EQ(2, storage->queryMeeting(getAllMeeting).size());
+  EXPECT_EQ("0", storage->findUserByName("Trevor")->getPhone());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  The binary snapshot is read while it matches the csv files, and can be
+ *  converted back to them
+ */
+TEST_F(StoragePrivateTest, BinarySnapshot) {
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->exportSnapshot());
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_EQ(4, storage->queryUser(getAllUser).size());
+  EXPECT_TRUE(testMeetingList(simMeetingList,
+                              storage->queryMeeting(getAllMeeting)));
+  storage->m_instance.reset();
+  storage.reset();
+
+  recFiles();
+  storage = Storage::getInstance();
+  EXPECT_EQ(3, storage->queryUser(getAllUser).size());
+  ASSERT_TRUE(storage->importSnapshot());
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  EXPECT_TRUE(testMeetingList(simMeetingList,
+                              storage->queryMeeting(getAllMeeting)));
+  storage->m_instance.reset();
+  storage.reset();
+  std::remove(Path::snapshotPath);
+}
+
+/*
+ *  A checkpoint writes the records cached from the last one unless they
+ *  changed, also after compaction renumbered them
+ */
+TEST_F(StoragePrivateTest, EncodedRecordCache) {
+  auto *csv = dynamic_cast<CsvBackend *>(storage->m_backend.get());
+  ASSERT_NE(nullptr, csv);
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->checkpoint());
+  EXPECT_EQ(4, std::count_if(csv->m_userLines.begin(), csv->m_userLines.end(),
+                             [](const string &line) { return !line.empty(); }));
+
+  //  user1 leaves a tombstone before the others, so they move down
+  storage->deleteUser(
+      [](const User &user) { return user.getName() == user1.getName(); });
+  storage->updateUser(
+      [](const User &user) { return user.getName() == user4.getName(); },
+      [](User &user) { user.setEmail("trevor@philips.com"); });
+  storage->updateMeeting(
+      [](const Meeting &meeting) {
+        return meeting.getTitle() == meeting1.getTitle();
+      },
+      [](Meeting &meeting) { meeting.setParticipator({"Geralt of Rivia"}); });
+  ASSERT_TRUE(storage->checkpoint());
+  EXPECT_EQ(3, csv->m_userLines.size());
+  storage->updateUser(
+      [](const User &user) { return user.getName() == user3.getName(); },
+      [](User &user) { user.setPhone("13611111111"); });
+  ASSERT_TRUE(storage->checkpoint());
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_FALSE(storage->userExists(user1.getName()));
+  EXPECT_EQ("trevor@philips.com",
+            storage->findUserByName(user4.getName())->getEmail());
+  EXPECT_EQ("13611111111",
+            storage->findUserByName(user3.getName())->getPhone());
+  EXPECT_EQ(user2.getEmail(),
+            storage->findUserByName(user2.getName())->getEmail());
+  EXPECT_EQ(vector<string>({"Geralt of Rivia"}),
+            storage->findMeetingByTitle(meeting1.getTitle())
+                ->getParticipator());
+  EXPECT_NE(nullptr, storage->findMeetingByTitle(meeting2.getTitle()));
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  The memory engine starts empty and never touches the data files
+ */
+TEST_F(StoragePrivateTest, MemoryEngine) {
+  storage->m_instance.reset();
+  storage.reset();
+  Storage::setBackend([]() { return Backend::create("memory"); });
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->queryUser(getAllUser).empty());
+  storage->createUser(user4);
+  EXPECT_TRUE(storage->sync());
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_FALSE(storage->userExists(user4.getName()));
+  storage->m_instance.reset();
+  storage.reset();
+  Storage::setBackend([]() { return Backend::create("csv"); });
+
+  storage = Storage::getInstance();
+  EXPECT_EQ(3, storage->queryUser(getAllUser).size());
+  EXPECT_FALSE(storage->userExists(user4.getName()));
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  The binary engine keeps the tables in one snapshot and its own journal
+ */
+TEST_F(StoragePrivateTest, BinaryEngine) {
+  storage->m_instance.reset();
+  storage.reset();
+  Storage::setBackend([]() { return Backend::create("binary"); });
+  EXPECT_EQ(nullptr, Backend::create("xml"));
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->queryUser(getAllUser).empty());
+  storage->createUser(user1);
+  ASSERT_TRUE(storage->checkpoint());
+  storage->createUser(user4);
+  ASSERT_TRUE(storage->sync());
+  std::ifstream journalStream(Path::binaryJournalPath);
+  string journal((std::istreambuf_iterator<char>(journalStream)),
+                 std::istreambuf_iterator<char>());
+  EXPECT_NE(string::npos, journal.find(user4.getName()));
+  storage->m_instance.reset();
+  storage.reset();
+
+  storage = Storage::getInstance();
+  EXPECT_TRUE(storage->userExists(user1.getName()));
+  EXPECT_TRUE(storage->userExists(user4.getName()));
+  EXPECT_EQ(2, storage->queryUser(getAllUser).size());
+  storage->m_instance.reset();
+  storage.reset();
+  Storage::setBackend([]() { return Backend::create("csv"); });
+  std::remove(Path::binaryPath);
+  std::remove(Path::binaryJournalPath);
+
+  storage = Storage::getInstance();
+  EXPECT_EQ(3, storage->queryUser(getAllUser).size());
+  storage->m_instance.reset();
+  storage.reset();
+}
+
+/*
+ *  Tenants keep their own tables in their own directories, apart from the
+ *  shared instance, and come back after an eviction, whatever characters
+ *  the root holds
+ */
+TEST_F(StoragePrivateTest, Tenants) {
+  const char *root = "data/tenants root";
+  std::filesystem::remove_all(root);
+  Tenants tenants(root);
+
+  shared_ptr<Storage> acme = tenants.open("acme");
+  shared_ptr<Storage> globex = tenants.open("globex");
+  ASSERT_NE(nullptr, acme);
+  ASSERT_NE(nullptr, globex);
+  EXPECT_EQ(acme, tenants.open("acme"));
+  EXPECT_EQ(nullptr, tenants.open(".."));
+  EXPECT_EQ(nullptr, tenants.open("acme/users"));
+  EXPECT_EQ(nullptr, tenants.open("acme corp"));
+  EXPECT_EQ(nullptr, tenants.open("acme\n"));
+
+  acme->createUser(user4);
+  acme->createMeeting(Meeting(user4.getName(), {"Acme Only"},
+                              Date(2020, 1, 1, 0, 0), Date(2020, 1, 1, 1, 0),
+                              "Acme Kickoff"));
+  EXPECT_TRUE(acme->userExists(user4.getName()));
+  EXPECT_FALSE(globex->userExists(user4.getName()));
+  EXPECT_FALSE(storage->userExists(user4.getName()));
+  EXPECT_EQ(3, storage->queryUser(getAllUser).size());
+
+  // a held tenant stays, however long it was idle
+  EXPECT_EQ(0, tenants.evictIdle(std::chrono::seconds(0)));
+  EXPECT_EQ(2, tenants.resident());
+  acme.reset();
+  globex.reset();
+  EXPECT_EQ(0, tenants.evictIdle(std::chrono::hours(1)));
+  EXPECT_EQ(2, tenants.evictIdle(std::chrono::seconds(0)));
+  EXPECT_EQ(0, tenants.resident());
+  // the names of an evicted tenant are given back
+  EXPECT_EQ(Symbols::none, Symbols::find("Acme Only"));
+
+  for (const Tenants::Usage &usage : tenants.usage()) {
+    EXPECT_FALSE(usage.resident);
+    if (usage.tenant == "acme") EXPECT_GT(usage.bytes, sizeof(User));
+  }
+
+  acme = tenants.open("acme");
+  EXPECT_TRUE(acme->userExists(user4.getName()));
+  EXPECT_EQ(1, acme->queryUser(getAllUser).size());
+  EXPECT_EQ(1, tenants.resident());
+
+  // the second eviction writes over the partitions of the first
+  acme->createUser(user1);
+  acme.reset();
+  EXPECT_EQ(1, tenants.evictIdle(std::chrono::seconds(0)));
+  acme = tenants.open("acme");
+  EXPECT_EQ(2, acme->queryUser(getAllUser).size());
+  acme.reset();
+  std::filesystem::remove_all(root);
+}
+
 /*
  *  Test destrutor and if the files are written correctly
  */
@@ -237,20 +1254,27 @@ TEST_F(StoragePrivateTest, WriteToFile) {
   storage->m_instance.reset();
   storage.reset();
 
-  std::fstream userTestfs;
-  userTestfs.open(userPath, std::fstream::in);
+  //  every record is in the partition of its user, or of its sponsor
+  auto readPartitions = [](const char *directory) {
+    std::vector<std::string> records;
+    for (int partition = 0; partition < Path::partitions; ++partition) {
+      std::ifstream stream(partitionPath(directory, partition));
+      for (string record; std::getline(stream, record);) {
+        records.push_back(record);
+        EXPECT_EQ(partition, Storage::partitionOf(record.substr(
+                                 1, record.find('"', 1) - 1)))
+            << record;
+      }
+    }
+    return records;
+  };
+
   std::vector<std::string> stdUsers{
       R"("Lara Croft","TombRaidar","lara@email.com","13800000000")",
       R"("Geralt of Rivia","TheWithcer","geralt@email.com","13700000000")",
       R"("Naked Snake","MetalGearSolid","snake@email.com","13600000000")",
       R"("Trevor","GrandTheftAutoV","Trevor@email.com","13500000000")"};
-  std::vector<std::string> testUsers;
-  string userTest;
-  while (userTestfs) {
-    std::getline(userTestfs, userTest);
-    testUsers.push_back(userTest);
-  }
-  testUsers.pop_back();
+  std::vector<std::string> testUsers = readPartitions(Path::userPath);
   if (stdUsers.size() != testUsers.size()) {
     FAIL() << "Compare users.csv failed\n"
            << stdUsers.size() << " " << testUsers.size();
@@ -260,24 +1284,13 @@ TEST_F(StoragePrivateTest, WriteToFile) {
     ASSERT_NE(testUsers.end(), pos);
   }
 
-  std::fstream meetingTestfs;
-  meetingTestfs.open(meetingPath, std::fstream::in);
-  std::vector<std::string> testMeetings;
-  string meetingTest;
-  while (meetingTestfs) {
-    std::getline(meetingTestfs, meetingTest);
-    testMeetings.push_back(meetingTest);
-  }
-  testMeetings.pop_back();
+  std::vector<std::string> testMeetings = readPartitions(Path::meetingPath);
   if (testMeetings.size() != 1) {
     FAIL() << "Compare meetings.csv failed";
   }
   ASSERT_EQ(
       R"("Geralt of Rivia","Naked Snake&Lara Croft","2016-07-10/15:00","2016-07-10/18:00","Want a few rounds of Gwent?")",
       testMeetings[0]);
-
-  userTestfs.close();
-  meetingTestfs.close();
 }
 
 #endif  //  TESTWRITETOFILE
@@ -1,5 +1,6 @@
 #include "utility.h"
 #include <gtest/gtest.h>
+#include <cstdio>
 
 using namespace std;
 
@@ -101,4 +102,9 @@ void utility::recFiles() {
   for (string &record : meetings) {
     f << record << endl;
   }
+  std::remove(journalPath);
+}
+
+string utility::partitionPath(const char *directory, int partition) {
+  return string(directory) + "/" + std::to_string(partition) + ".csv";
 }
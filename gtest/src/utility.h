@@ -22,10 +22,14 @@ bool testUserList(const list<User> &expectList, const list<User> &actualList);
 bool testMeetingList(const list<Meeting> &expectList,
                      const list<Meeting> &actualList);
 void recFiles();
+//  Path to the csv file of a partition
+string partitionPath(const char *directory, int partition);
 
-//  Path to csv
+//  Path to the csv files Storage imports in place of its partitions
 const char *const userPath = "data/users.csv";
 const char *const meetingPath = "data/meetings.csv";
+//  Journal of the mutations not yet folded into the csv files
+const char *const journalPath = "data/journal.log";
 }  // namespace utility
 
 #endif /* UTILITY_H */
@@ -3,15 +3,47 @@
 
 #include <list>
 #include <string>
+#include <vector>
+#include "AgendaView.hpp"
 #include "Storage.hpp"
 
 class AgendaService {
  public:
+  /**
+   * a meeting to create in a batch, with the arguments of createMeeting
+   */
+  struct MeetingRequest {
+    std::string sponsor;
+    std::string title;
+    std::string startDate;
+    std::string endDate;
+    std::vector<std::string> participator;
+  };
+
+  /**
+   * the outcome of one meeting of a batch
+   */
+  struct MeetingResult {
+    // if the meeting was created
+    bool created;
+    // the type and message of what createMeeting would have thrown, empty
+    // if the meeting was created
+    std::string error;
+    std::string message;
+  };
+
   /**
    * constructor
    */
   AgendaService();
 
+  /**
+   * constructor, serving the tables of a storage of its own instead of
+   * the shared instance
+   * @param t_storage the storage
+   */
+  explicit AgendaService(std::shared_ptr<Storage> t_storage);
+
   /**
    * destructor
    */
@@ -63,6 +95,17 @@ class AgendaService {
                      const std::string &startDate, const std::string &endDate,
                      const std::vector<std::string> &participator);
 
+  /**
+   * create many meetings at once, as if createMeeting were called on each in
+   * turn, so a meeting conflicting with an earlier one of the batch is
+   * refused. The users are looked up once each, and every created meeting
+   * reaches the storage in one transaction
+   * @param batch the meetings to create
+   * @return the outcome of each meeting, in the order of the batch
+   */
+  std::vector<MeetingResult> createMeetings(
+      const std::vector<MeetingRequest> &batch);
+
   /**
    * add a participator to a meeting
    * @param userName the sponsor's userName
@@ -151,7 +194,21 @@ class AgendaService {
   bool deleteAllMeetings(const std::string &userName);
 
   /**
-   * start Agenda service and connect to storage
+   * take a read-only view of the current version of the storage, its
+   * answers stay the same however the storage changes later
+   * @return the view
+   */
+  AgendaView view(void) const;
+
+  /**
+   * measure the memory of the storage
+   * @return the bytes of each component of the storage
+   */
+  Storage::MemoryStats memoryStats(void) const;
+
+  /**
+   * start Agenda service and connect to storage, the shared instance
+   * unless one was given to the constructor
    */
   void startAgenda(void);
 
@@ -1,6 +1,7 @@
 #ifndef AGENDA_UI_HPP_
 #define AGENDA_UI_HPP_
 
+#include <csignal>
 #include <iostream>
 #include <string>
 #include "AgendaService.hpp"
@@ -16,6 +17,16 @@ class AgendaUI {
    */
   void quitAgenda(int error);
 
+  /**
+   * ask the operation loop to stop, safe to call from a signal handler
+   */
+  static void interrupt(void);
+
+  /**
+   * @return if the operation loop was interrupted
+   */
+  static bool interrupted(void);
+
  private:
   /**
    * constructor
@@ -114,6 +125,11 @@ class AgendaUI {
    */
   void deleteAllMeetings();
 
+  /**
+   * show the memory the storage uses, by component
+   */
+  void showMemoryStats();
+
   /**
    * show the meetings in the s creen
    */
@@ -123,6 +139,7 @@ class AgendaUI {
   std::string m_userPassword;
   AgendaService m_agendaService;
   std::shared_ptr<Logger> m_logger;
+  static volatile std::sig_atomic_t m_interrupted;
 };
 
 #endif
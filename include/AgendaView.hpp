@@ -0,0 +1,79 @@
+#ifndef AGENDA_VIEW_HPP_
+#define AGENDA_VIEW_HPP_
+
+#include <list>
+#include <memory>
+#include <string>
+#include "Version.hpp"
+
+/**
+ * the read-only queries of AgendaService answered from one pinned version of
+ * the tables, so every answer comes from the same point in time and no
+ * query waits for or blocks a writer
+ */
+class AgendaView {
+ public:
+  /**
+   * constructor
+   * @param t_version the version to answer from
+   */
+  explicit AgendaView(std::shared_ptr<const Version> t_version);
+
+  /**
+   * @return the version the view answers from
+   */
+  const Version &version(void) const;
+
+  /**
+   * list all users
+   * @return a user list result
+   */
+  std::list<User> listAllUsers(void) const;
+
+  /**
+   * search a meeting by username and title
+   * @param userName as a sponsor OR a participator
+   * @param title the meeting's title
+   * @return a meeting list result
+   */
+  std::list<Meeting> meetingQuery(const std::string &userName,
+                                  const std::string &title) const;
+
+  /**
+   * search a meeting by username, time interval
+   * @param userName as a sponsor OR a participator
+   * @param startDate time interval's start date
+   * @param endDate time interval's end date
+   * @return a meeting list result
+   */
+  std::list<Meeting> meetingQuery(const std::string &userName,
+                                  const std::string &startDate,
+                                  const std::string &endDate) const;
+
+  /**
+   * list all meetings the user take part in
+   * @param userName user's username
+   * @return a meeting list result
+   */
+  std::list<Meeting> listAllMeetings(const std::string &userName) const;
+
+  /**
+   * list all meetings the user sponsor
+   * @param userName user's username
+   * @return a meeting list result
+   */
+  std::list<Meeting> listAllSponsorMeetings(const std::string &userName) const;
+
+  /**
+   * list all meetings the user take part in and sponsor by other
+   * @param userName user's username
+   * @return a meeting list result
+   */
+  std::list<Meeting> listAllParticipateMeetings(
+      const std::string &userName) const;
+
+ private:
+  std::shared_ptr<const Version> m_version;
+};
+
+#endif
@@ -0,0 +1,353 @@
+#ifndef BACKEND_HPP_
+#define BACKEND_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Journal.hpp"
+#include "Meeting.hpp"
+#include "Slab.hpp"
+#include "User.hpp"
+
+/**
+ * where a storage keeps its tables between runs. A backend loads the base
+ * tables, keeps the change records logged on top of them, and persists the
+ * tables as a new base, which drops the change records. The storage calls
+ * it under the table lock, except writeChanges
+ */
+class Backend {
+ public:
+  typedef std::function<void(std::string_view, int)> Replayer;
+
+  virtual ~Backend() {}
+
+  /**
+   * make a backend by the name of its engine
+   * @param t_engine csv, binary or memory
+   * @param t_directory the data directory, the default one if empty
+   * @return the backend, or nullptr if there is no such engine
+   */
+  static std::unique_ptr<Backend> create(const std::string &t_engine,
+                                         const std::string &t_directory = "");
+
+  /**
+   * load the base tables
+   * @param t_users the user table, empty
+   * @param t_meetings the meeting table, empty
+   */
+  virtual void load(Slab<User> &t_users, Slab<Meeting> &t_meetings) = 0;
+
+  /**
+   * replay the change records logged on top of the base tables
+   * @param t_replay called with every record and its line number
+   */
+  virtual void replay(const Replayer &t_replay) = 0;
+
+  /**
+   * note that a user changed since the base tables were persisted
+   * @param t_userName the username
+   */
+  virtual void markUser(const std::string & /*t_userName*/) {}
+
+  /**
+   * note that a meeting changed since the base tables were persisted
+   * @param t_sponsor the sponsor of the meeting
+   */
+  virtual void markMeeting(const std::string & /*t_sponsor*/) {}
+
+  /**
+   * note that the record at a handle of the user table changed
+   * @param t_user the handle
+   */
+  virtual void touchUser(Slab<User>::Handle /*t_user*/) {}
+
+  /**
+   * note that the record at a handle of the meeting table changed
+   * @param t_meeting the handle
+   */
+  virtual void touchMeeting(Slab<Meeting>::Handle /*t_meeting*/) {}
+
+  /**
+   * note that the tables were compacted
+   * @param t_users the new handle of every old user handle, see Slab::compact
+   * @param t_meetings the new handle of every old meeting handle
+   */
+  virtual void renumber(
+      const std::vector<Slab<User>::Handle> & /*t_users*/,
+      const std::vector<Slab<Meeting>::Handle> & /*t_meetings*/) {}
+
+  /**
+   * @return the bytes the backend keeps in memory beside the tables
+   */
+  virtual std::size_t footprint(void) const { return 0; }
+
+  /**
+   * buffer a change record
+   * @param t_record the record, without '\n'
+   */
+  virtual void append(const std::string &t_record) = 0;
+
+  /**
+   * buffer a group of change records replayed whole or not at all
+   * @param t_records the records, without '\n'
+   */
+  virtual void appendGroup(const std::vector<std::string> &t_records) = 0;
+
+  /**
+   * @return if the change records cost more to replay than the tables to
+   * persist, true will be returned
+   */
+  virtual bool full(void) const = 0;
+
+  /**
+   * hand over the buffered change records, so they can be written by
+   * writeChanges while new records are buffered
+   * @return the records
+   */
+  virtual std::string takeChanges(void) = 0;
+
+  /**
+   * write change records taken from the buffer. It may run beside append on
+   * another thread
+   * @param t_records the records
+   * @param t_durable if the call waits until they are on disk
+   * @return if success, true will be returned
+   */
+  virtual bool writeChanges(const std::string &t_records,
+                            bool t_durable) const = 0;
+
+  /**
+   * put change records taken from the buffer back in front of it, after
+   * writeChanges failed, so the next write retries them
+   * @param t_records the records
+   */
+  virtual void restoreChanges(const std::string &t_records) = 0;
+
+  /**
+   * persist the tables as the new base and drop the change records
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   * @param t_durable if the call waits until they are on disk
+   * @return if success, true will be returned
+   */
+  virtual bool persist(const Slab<User> &t_users,
+                       const Slab<Meeting> &t_meetings, bool t_durable) = 0;
+
+  /**
+   * keep a binary snapshot beside the base from the next persist on
+   * @return if the engine can keep one, true will be returned
+   */
+  virtual bool keepSnapshot(void) { return false; }
+
+  /**
+   * replace the tables with the binary snapshot kept beside the base, the
+   * next persist writes all of them
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   * @return if success, true will be returned
+   */
+  virtual bool loadSnapshot(Slab<User> & /*t_users*/,
+                            Slab<Meeting> & /*t_meetings*/) {
+    return false;
+  }
+};
+
+/**
+ * a backend logging its change records to a journal file
+ */
+class JournalBackend : public Backend {
+ public:
+  /**
+   * constructor
+   * @param t_directory the data directory, the default one if empty
+   */
+  explicit JournalBackend(const std::string &t_directory);
+
+  virtual void append(const std::string &t_record);
+
+  virtual void appendGroup(const std::vector<std::string> &t_records);
+
+  virtual bool full(void) const;
+
+  virtual std::string takeChanges(void);
+
+  virtual bool writeChanges(const std::string &t_records,
+                            bool t_durable) const;
+
+  virtual void restoreChanges(const std::string &t_records);
+
+ protected:
+  /**
+   * @param t_path a path under the default data directory
+   * @return the same path under the data directory of the backend
+   */
+  std::string path(const char *t_path) const;
+
+  // the data directory, empty for the default one
+  std::string m_directory;
+  Journal m_journal;
+};
+
+/**
+ * the csv engine: the tables are kept as csv partitions of users and
+ * meetings, hashed by username, and only the changed partitions are written
+ * again, from the records encoded the last time unless they changed since.
+ * A users.csv and meetings.csv found at start are imported in place of the
+ * partitions. A binary snapshot of the partitions may be kept beside them,
+ * read instead of them on start to skip parsing the text and the dates
+ */
+class CsvBackend : public JournalBackend {
+ public:
+  /**
+   * constructor, the tables are read by load
+   * @param t_directory the data directory, the default one if empty
+   */
+  explicit CsvBackend(const std::string &t_directory = "");
+
+  /**
+   * the partition a username falls in, users are placed by their names and
+   * meetings by their sponsors
+   * @param t_userName the username
+   * @return the number of the partition, below Path::partitions
+   */
+  static int partitionOf(const std::string &t_userName);
+
+  virtual void load(Slab<User> &t_users, Slab<Meeting> &t_meetings);
+
+  virtual void replay(const Replayer &t_replay);
+
+  virtual void markUser(const std::string &t_userName);
+
+  virtual void markMeeting(const std::string &t_sponsor);
+
+  virtual void touchUser(Slab<User>::Handle t_user);
+
+  virtual void touchMeeting(Slab<Meeting>::Handle t_meeting);
+
+  virtual void renumber(const std::vector<Slab<User>::Handle> &t_users,
+                        const std::vector<Slab<Meeting>::Handle> &t_meetings);
+
+  virtual std::size_t footprint(void) const;
+
+  virtual bool persist(const Slab<User> &t_users,
+                       const Slab<Meeting> &t_meetings, bool t_durable);
+
+  virtual bool keepSnapshot(void);
+
+  virtual bool loadSnapshot(Slab<User> &t_users, Slab<Meeting> &t_meetings);
+
+ private:
+  /**
+   * read the partitions, or the files to import, in parallel
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   */
+  void readFromFile(Slab<User> &t_users, Slab<Meeting> &t_meetings);
+
+  /**
+   * write the changed partitions. The generation moves on once their
+   * manifest is committed, even if moving the files into place fails after
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   * @param t_durable if the call waits until they are on disk
+   * @return if success, true will be returned
+   */
+  bool writeToFile(const Slab<User> &t_users, const Slab<Meeting> &t_meetings,
+                   bool t_durable);
+
+  /**
+   * read the binary snapshot
+   * @param t_current if only a snapshot of the current csv files is read
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   * @return if success, true will be returned
+   */
+  bool readFromSnapshot(bool t_current, Slab<User> &t_users,
+                        Slab<Meeting> &t_meetings);
+
+  /**
+   * write the binary snapshot
+   * @param t_users the user table
+   * @param t_meetings the meeting table
+   * @param t_durable if the call waits until it is on disk
+   * @return if success, true will be returned
+   */
+  bool writeToSnapshot(const Slab<User> &t_users,
+                       const Slab<Meeting> &t_meetings, bool t_durable);
+
+  // the generation of the last committed snapshot
+  unsigned long long m_generation;
+  // the partitions changed since the base files were written, and the
+  // stamps of the files to import while they are the base files
+  std::vector<unsigned char> m_dirtyUserPartitions;
+  std::vector<unsigned char> m_dirtyMeetingPartitions;
+  std::vector<std::string> m_importStamps;
+  // if persisting refreshes the binary snapshot
+  bool m_snapshot;
+  // handle -> the record as last written with its '\n', empty once the
+  // record changes, so writing a partition mostly copies these
+  std::vector<std::string> m_userLines;
+  std::vector<std::string> m_meetingLines;
+};
+
+/**
+ * the binary engine: the tables are kept as one binary snapshot, written
+ * whole on every persist
+ */
+class BinaryBackend : public JournalBackend {
+ public:
+  /**
+   * constructor, the tables are read by load
+   * @param t_directory the data directory, the default one if empty
+   */
+  explicit BinaryBackend(const std::string &t_directory = "");
+
+  virtual void load(Slab<User> &t_users, Slab<Meeting> &t_meetings);
+
+  virtual void replay(const Replayer &t_replay);
+
+  virtual bool persist(const Slab<User> &t_users,
+                       const Slab<Meeting> &t_meetings, bool t_durable);
+
+ private:
+  // the generation of the tables, stamped in their file
+  unsigned long long m_generation;
+};
+
+/**
+ * the memory engine: the tables start empty and nothing is ever read or
+ * written, for tests and benchmarks free of disk noise
+ */
+class MemoryBackend : public Backend {
+ public:
+  virtual void load(Slab<User> & /*t_users*/,
+                    Slab<Meeting> & /*t_meetings*/) {}
+
+  virtual void replay(const Replayer & /*t_replay*/) {}
+
+  virtual void append(const std::string & /*t_record*/) {}
+
+  virtual void appendGroup(const std::vector<std::string> & /*t_records*/) {}
+
+  virtual bool full(void) const { return false; }
+
+  virtual std::string takeChanges(void) { return std::string(); }
+
+  virtual bool writeChanges(const std::string & /*t_records*/,
+                            bool /*t_durable*/) const {
+    return true;
+  }
+
+  virtual void restoreChanges(const std::string & /*t_records*/) {}
+
+  virtual bool persist(const Slab<User> & /*t_users*/,
+                       const Slab<Meeting> & /*t_meetings*/,
+                       bool /*t_durable*/) {
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef BLOOM_FILTER_HPP_
+#define BLOOM_FILTER_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * a set of strings answering "maybe present" or "surely absent" from a few
+ * bits per string. Strings are never taken out, so a filter is rebuilt
+ * through reset once many of its strings are gone. Sized for its capacity,
+ * about one absent string in a hundred is answered maybe
+ */
+class BloomFilter {
+ public:
+  /**
+   * default constructor, holds no bits and answers maybe to everything
+   */
+  BloomFilter();
+
+  /**
+   * drop every string and size the filter for a number of them
+   * @param t_capacity the number of strings the filter is sized for
+   */
+  void reset(std::size_t t_capacity);
+
+  /**
+   * add a string
+   * @param t_key the string
+   */
+  void insert(std::string_view t_key);
+
+  /**
+   * @param t_key a string
+   * @return if the string may have been added, true will be returned, false
+   * means it surely was not
+   */
+  bool mightContain(std::string_view t_key) const;
+
+  /**
+   * @return the number of strings added since the last reset
+   */
+  std::size_t keys(void) const { return this->m_keys; }
+
+  /**
+   * @return the number of strings the filter is sized for
+   */
+  std::size_t capacity(void) const { return this->m_capacity; }
+
+  /**
+   * @return the bytes the bits take on the heap
+   */
+  std::size_t bytes(void) const {
+    return this->m_words.capacity() * sizeof(std::uint64_t);
+  }
+
+  /**
+   * @return the chance an absent string is answered maybe, estimated from
+   * the strings added so far
+   */
+  double expectedRate(void) const;
+
+ private:
+  std::vector<std::uint64_t> m_words;
+  // the number of bits minus one, the number of bits is a power of two
+  std::uint64_t m_mask;
+  std::size_t m_keys;
+  std::size_t m_capacity;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <initializer_list>
 #include <string>
+#include <string_view>
 
 class Date {
  public:
@@ -20,6 +21,12 @@ class Date {
    * @brief constructor with a string
    */
   Date(const std::string &dateString);
+
+  /**
+   * @brief copy constructor
+   */
+  Date(const Date &t_date) = default;
+
   /**
    * @brief return the year of a Date
    * @return   a integer indicate the year of a date
@@ -91,7 +98,7 @@ class Date {
    * 0000-00-00/00:00
    * @return a date
    */
-  static Date stringToDate(const std::string &t_dateString);
+  static Date stringToDate(std::string_view t_dateString);
 
   /**
    * @brief convert a date to string, if the date is invalid return
@@ -99,6 +106,19 @@ class Date {
    */
   static std::string dateToString(const Date &t_date);
 
+  /**
+   * @brief convert a date to the number of minutes since 0000-03-01/00:00,
+   * later dates always get larger numbers
+   * @return the minutes of the date
+   */
+  static long long dateToMinutes(const Date &t_date);
+
+  /**
+   * @brief convert the minutes counted by dateToMinutes back to a date
+   * @return the date of the minutes
+   */
+  static Date minutesToDate(long long t_minutes);
+
   /**
    *  @brief overload the assign operator
    */
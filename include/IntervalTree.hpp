@@ -0,0 +1,330 @@
+#ifndef INTERVAL_TREE_HPP_
+#define INTERVAL_TREE_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/**
+ * an AVL tree of half-open intervals [start, end) ordered by start, every
+ * node also knows the largest end in its subtree so overlaps are found in
+ * logarithmic time
+ */
+template <typename T>
+class IntervalTree {
+ public:
+  struct Interval {
+    long long start;
+    long long end;
+    T value;
+  };
+
+  IntervalTree() : m_root(nullptr), m_size(0) {}
+
+  IntervalTree(const IntervalTree &t_another) = delete;
+  IntervalTree &operator=(const IntervalTree &t_another) = delete;
+
+  IntervalTree(IntervalTree &&t_another)
+      : m_root(t_another.m_root), m_size(t_another.m_size) {
+    t_another.m_root = nullptr;
+    t_another.m_size = 0;
+  }
+
+  IntervalTree &operator=(IntervalTree &&t_another) {
+    if (this != &t_another) {
+      destroy(this->m_root);
+      this->m_root = t_another.m_root;
+      this->m_size = t_another.m_size;
+      t_another.m_root = nullptr;
+      t_another.m_size = 0;
+    }
+
+    return *this;
+  }
+
+  ~IntervalTree() { destroy(this->m_root); }
+
+  /**
+   * add an interval
+   * @param t_start the start of the interval
+   * @param t_end the end of the interval, excluded
+   * @param t_value the value carried by the interval
+   */
+  void insert(long long t_start, long long t_end, const T &t_value) {
+    this->m_root = insert(this->m_root, t_start, t_end, t_value);
+    ++this->m_size;
+  }
+
+  /**
+   * replace every interval at once, in linear time
+   * @param t_intervals the intervals ordered by start, then by value
+   */
+  void assign(const std::vector<Interval> &t_intervals) {
+    destroy(this->m_root);
+    this->m_root = build(t_intervals, 0, t_intervals.size());
+    this->m_size = t_intervals.size();
+  }
+
+  /**
+   * remove an interval added before
+   * @param t_start the start of the interval
+   * @param t_value the value carried by the interval
+   * @return if the interval was found, true will be returned
+   */
+  bool erase(long long t_start, const T &t_value) {
+    bool erased = false;
+
+    this->m_root = erase(this->m_root, t_start, t_value, erased);
+
+    if (erased) --this->m_size;
+
+    return erased;
+  }
+
+  /**
+   * find the earliest interval overlapping [t_start, t_end)
+   * @param t_start the start of the range
+   * @param t_end the end of the range, excluded
+   * @return the value of the interval, or nullptr if nothing overlaps
+   */
+  const T *findOverlap(long long t_start, long long t_end) const {
+    const Node *node = this->m_root;
+
+    while (node != nullptr) {
+      // if the left subtree has no overlap then nothing on the right has one
+      // either, because everything there starts even later
+      if (node->left != nullptr && node->left->maxEnd > t_start) {
+        node = node->left;
+      } else if (node->start < t_end && node->end > t_start) {
+        return &node->value;
+      } else if (node->start >= t_end) {
+        return nullptr;
+      } else {
+        node = node->right;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * visit every interval overlapping [t_start, t_end) in the order of their
+   * starts
+   * @param t_start the start of the range
+   * @param t_end the end of the range, excluded
+   * @param visitor a lambda function called with the value of each interval
+   */
+  template <typename Visitor>
+  void forEachOverlap(long long t_start, long long t_end,
+                      Visitor &&visitor) const {
+    forEachOverlap(this->m_root, t_start, t_end, visitor);
+  }
+
+  /**
+   * @return the number of intervals
+   */
+  std::size_t size(void) const { return this->m_size; }
+
+  /**
+   * @return if there is no interval, true will be returned
+   */
+  bool empty(void) const { return this->m_size == 0; }
+
+  /**
+   * @return the bytes the nodes take on the heap
+   */
+  std::size_t bytes(void) const { return this->m_size * sizeof(Node); }
+
+ private:
+  struct Node {
+    Node(long long t_start, long long t_end, const T &t_value)
+        : start(t_start),
+          end(t_end),
+          maxEnd(t_end),
+          value(t_value),
+          height(1),
+          left(nullptr),
+          right(nullptr) {}
+
+    long long start;
+    long long end;
+    long long maxEnd;
+    T value;
+    int height;
+    Node *left;
+    Node *right;
+  };
+
+  static int height(const Node *t_node) {
+    return t_node == nullptr ? 0 : t_node->height;
+  }
+
+  static void update(Node *t_node) {
+    t_node->height = std::max(height(t_node->left), height(t_node->right)) + 1;
+    t_node->maxEnd = t_node->end;
+
+    if (t_node->left != nullptr)
+      t_node->maxEnd = std::max(t_node->maxEnd, t_node->left->maxEnd);
+
+    if (t_node->right != nullptr)
+      t_node->maxEnd = std::max(t_node->maxEnd, t_node->right->maxEnd);
+  }
+
+  static Node *rotateLeft(Node *t_node) {
+    Node *root = t_node->right;
+
+    t_node->right = root->left;
+    root->left = t_node;
+    update(t_node);
+    update(root);
+
+    return root;
+  }
+
+  static Node *rotateRight(Node *t_node) {
+    Node *root = t_node->left;
+
+    t_node->left = root->right;
+    root->right = t_node;
+    update(t_node);
+    update(root);
+
+    return root;
+  }
+
+  static Node *balance(Node *t_node) {
+    update(t_node);
+
+    int factor = height(t_node->left) - height(t_node->right);
+
+    if (factor > 1) {
+      if (height(t_node->left->left) < height(t_node->left->right))
+        t_node->left = rotateLeft(t_node->left);
+
+      return rotateRight(t_node);
+    }
+
+    if (factor < -1) {
+      if (height(t_node->right->right) < height(t_node->right->left))
+        t_node->right = rotateRight(t_node->right);
+
+      return rotateLeft(t_node);
+    }
+
+    return t_node;
+  }
+
+  /**
+   * order intervals by start, the value breaks ties so erase can find the
+   * exact node again
+   */
+  static bool less(long long t_start, const T &t_value, const Node *t_node) {
+    if (t_start != t_node->start) return t_start < t_node->start;
+
+    return std::less<T>()(t_value, t_node->value);
+  }
+
+  static Node *insert(Node *t_node, long long t_start, long long t_end,
+                      const T &t_value) {
+    if (t_node == nullptr) return new Node(t_start, t_end, t_value);
+
+    if (less(t_start, t_value, t_node)) {
+      t_node->left = insert(t_node->left, t_start, t_end, t_value);
+    } else {
+      t_node->right = insert(t_node->right, t_start, t_end, t_value);
+    }
+
+    return balance(t_node);
+  }
+
+  /**
+   * build a balanced tree of the intervals in [t_first, t_last)
+   */
+  static Node *build(const std::vector<Interval> &t_intervals,
+                     std::size_t t_first, std::size_t t_last) {
+    if (t_first == t_last) return nullptr;
+
+    std::size_t middle = t_first + (t_last - t_first) / 2;
+    const Interval &interval = t_intervals[middle];
+    Node *node = new Node(interval.start, interval.end, interval.value);
+
+    node->left = build(t_intervals, t_first, middle);
+    node->right = build(t_intervals, middle + 1, t_last);
+    update(node);
+
+    return node;
+  }
+
+  static Node *detachMin(Node *t_node, Node *&t_min) {
+    if (t_node->left == nullptr) {
+      t_min = t_node;
+
+      return t_node->right;
+    }
+
+    t_node->left = detachMin(t_node->left, t_min);
+
+    return balance(t_node);
+  }
+
+  static Node *erase(Node *t_node, long long t_start, const T &t_value,
+                     bool &t_erased) {
+    if (t_node == nullptr) return nullptr;
+
+    if (t_start == t_node->start && t_value == t_node->value) {
+      Node *left = t_node->left;
+      Node *right = t_node->right;
+
+      delete t_node;
+      t_erased = true;
+
+      if (right == nullptr) return left;
+
+      Node *min = nullptr;
+
+      right = detachMin(right, min);
+      min->left = left;
+      min->right = right;
+
+      return balance(min);
+    }
+
+    if (less(t_start, t_value, t_node)) {
+      t_node->left = erase(t_node->left, t_start, t_value, t_erased);
+    } else {
+      t_node->right = erase(t_node->right, t_start, t_value, t_erased);
+    }
+
+    return balance(t_node);
+  }
+
+  template <typename Visitor>
+  static void forEachOverlap(const Node *t_node, long long t_start,
+                             long long t_end, Visitor &t_visitor) {
+    // a subtree ending before the range holds no overlap
+    if (t_node == nullptr || t_node->maxEnd <= t_start) return;
+
+    forEachOverlap(t_node->left, t_start, t_end, t_visitor);
+
+    // the node and everything on its right start after the range
+    if (t_node->start >= t_end) return;
+
+    if (t_node->end > t_start) t_visitor(t_node->value);
+
+    forEachOverlap(t_node->right, t_start, t_end, t_visitor);
+  }
+
+  static void destroy(Node *t_node) {
+    if (t_node == nullptr) return;
+
+    destroy(t_node->left);
+    destroy(t_node->right);
+    delete t_node;
+  }
+
+  Node *m_root;
+  std::size_t m_size;
+};
+
+#endif
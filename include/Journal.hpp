@@ -0,0 +1,129 @@
+#ifndef JOURNAL_HPP_
+#define JOURNAL_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * an append-only file of one-line records logged on top of a base snapshot.
+ * The first line of the file stamps the snapshot the records belong to, so a
+ * journal left behind by an older snapshot is thrown away instead of replayed,
+ * and one of any other snapshot is refused.
+ * A group of records is led by a "T <count>" line and replayed only if all of
+ * its records reached the file
+ */
+class Journal {
+ public:
+  /**
+   * default constructor, opens nothing
+   */
+  Journal();
+
+  /**
+   * disallow the copy constructor and assign operator
+   */
+  Journal(const Journal &t_another) = delete;
+  void operator=(const Journal &t_another) = delete;
+
+  /**
+   * destructor, flushes and closes the file
+   */
+  ~Journal();
+
+  /**
+   * open a journal file, creating it if needed, and replay its records
+   * @param t_path the path of the file
+   * @param t_base the stamp of the base snapshot the records must belong to
+   * @param t_replay called with every complete record and its line number
+   * @param t_older tells if the stamp of another snapshot names an older one,
+   * whose records were persisted before the journal was started over
+   * @return if success, true will be returned
+   * @throw wrong_format if the records belong to a snapshot neither the base
+   * nor an older one, so they are kept instead of dropped
+   */
+  bool open(const char *t_path, const std::string &t_base,
+            const std::function<void(std::string_view, int)> &t_replay,
+            const std::function<bool(std::string_view)> &t_older);
+
+  /**
+   * flush and close the file
+   */
+  void close(void);
+
+  /**
+   * @return if a file is open, true will be returned
+   */
+  bool isOpen(void) const;
+
+  /**
+   * buffer a record, it reaches the file on the next flush
+   * @param t_record the record, without '\n'
+   */
+  void append(const std::string &t_record);
+
+  /**
+   * buffer a group of records that is replayed whole or not at all
+   * @param t_records the records, without '\n'
+   */
+  void appendGroup(const std::vector<std::string> &t_records);
+
+  /**
+   * write the buffered records to the file, they stay buffered on failure
+   * @return if success, true will be returned
+   */
+  bool flush(void);
+
+  /**
+   * write the buffered records and wait until they are on disk, they stay
+   * buffered on failure
+   * @return if success, true will be returned
+   */
+  bool sync(void);
+
+  /**
+   * hand over the buffered records, so they can be written by write() while
+   * new records are buffered
+   * @return the records, each ending with '\n'
+   */
+  std::string takeBuffer(void);
+
+  /**
+   * put records taken from the buffer back in front of it, when writing
+   * them failed
+   * @param t_records the records, each ending with '\n'
+   */
+  void restoreBuffer(const std::string &t_records);
+
+  /**
+   * write records taken from the buffer to the file. It only reads the file
+   * descriptor, so it may run beside append() on another thread. On failure
+   * the file is cut back to where it ended, so a retry writes the records
+   * whole
+   * @param t_records the records, each ending with '\n'
+   * @param t_durable if the call waits until they are on disk
+   * @return if success, true will be returned
+   */
+  bool write(const std::string &t_records, bool t_durable) const;
+
+  /**
+   * drop every record and start over on a new base snapshot
+   * @param t_base the stamp of the new base snapshot
+   * @return if success, true will be returned
+   */
+  bool reset(const std::string &t_base);
+
+  /**
+   * @return the number of records since the base snapshot
+   */
+  std::size_t records(void) const;
+
+ private:
+  int m_fd;
+  std::string m_buffer;
+  std::size_t m_records;
+};
+
+#endif
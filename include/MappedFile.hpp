@@ -0,0 +1,50 @@
+#ifndef MAPPED_FILE_HPP_
+#define MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * a whole file mapped read-only into memory
+ */
+class MappedFile {
+ public:
+  /**
+   * default constructor, maps nothing
+   */
+  MappedFile();
+
+  /**
+   * disallow the copy constructor and assign operator
+   */
+  MappedFile(const MappedFile &t_another) = delete;
+  void operator=(const MappedFile &t_another) = delete;
+
+  /**
+   * destructor, unmaps the file
+   */
+  ~MappedFile();
+
+  /**
+   * map a file, replacing the current one
+   * @param t_path the path of the file
+   * @return if success, true will be returned
+   */
+  bool open(const char *t_path);
+
+  /**
+   * unmap the current file
+   */
+  void close(void);
+
+  /**
+   * @return the content of the file, empty if nothing is mapped
+   */
+  std::string_view content(void) const;
+
+ private:
+  const char *m_data;
+  std::size_t m_size;
+};
+
+#endif
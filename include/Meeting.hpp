@@ -1,9 +1,16 @@
 #ifndef MEETING_HPP_
 #define MEETING_HPP_
 
+#include <string>
 #include <vector>
 #include "Date.hpp"
+#include "Symbols.hpp"
 
+/**
+ * the sponsor and participators are kept as ids of the symbol table, the
+ * string accessors translate at the edge. A meeting holds a reference to
+ * each of its ids, so the names of meetings gone are taken out
+ */
 class Meeting {
  public:
   /**
@@ -24,11 +31,37 @@ class Meeting {
    */
   Meeting(const Meeting &t_meeting);
 
+  /**
+   * @brief move constructor
+   */
+  Meeting(Meeting &&t_meeting) noexcept;
+
+  /**
+   * @brief copy assignment
+   */
+  Meeting &operator=(const Meeting &t_meeting);
+
+  /**
+   * @brief move assignment
+   */
+  Meeting &operator=(Meeting &&t_meeting) noexcept;
+
+  /**
+   * @brief destructor, releases the ids
+   */
+  ~Meeting();
+
   /**
    *   @brief get the meeting's sponsor
    *   @return a string indicate sponsor
    */
-  std::string getSponsor(void) const;
+  const std::string &getSponsor(void) const;
+
+  /**
+   *   @brief get the id of the meeting's sponsor
+   *   @return the id in the symbol table
+   */
+  Symbols::Id getSponsorId(void) const;
 
   /**
    * @brief set the sponsor of a meeting
@@ -42,6 +75,12 @@ class Meeting {
    */
   std::vector<std::string> getParticipator(void) const;
 
+  /**
+   * @brief  get the ids of the participators of a meeting
+   * @return the ids in the symbol table
+   */
+  const std::vector<Symbols::Id> &getParticipatorIds(void) const;
+
   /**
    *   @brief set the new participators of a meeting
    *   @param the new participators vector
@@ -64,7 +103,7 @@ class Meeting {
    * @brief get the startDate of a meeting
    * @return return a string indicate startDate
    */
-  Date getStartDate(void) const;
+  const Date &getStartDate(void) const;
 
   /**
    * @brief  set the startDate of a meeting
@@ -76,7 +115,7 @@ class Meeting {
    * @brief get the endDate of a meeting
    * @return a date indicate the endDate
    */
-  Date getEndDate(void) const;
+  const Date &getEndDate(void) const;
 
   /**
    * @brief  set the endDate of a meeting
@@ -88,7 +127,7 @@ class Meeting {
    * @brief get the title of a meeting
    * @return a date title the endDate
    */
-  std::string getTitle(void) const;
+  const std::string &getTitle(void) const;
 
   /**
    * @brief  set the title of a meeting
@@ -103,9 +142,16 @@ class Meeting {
    */
   bool isParticipator(const std::string &t_username) const;
 
+  /**
+   * @brief check if the user take part in this meeting
+   * @param t_user the id of the user
+   * @return if the user take part in this meeting
+   */
+  bool isParticipator(Symbols::Id t_user) const;
+
  private:
-  std::string m_sponsor;
-  std::vector<std::string> m_participators;
+  Symbols::Id m_sponsor = Symbols::empty;
+  std::vector<Symbols::Id> m_participators;
   Date m_startDate;
   Date m_endDate;
   std::string m_title;
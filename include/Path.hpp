@@ -1,18 +1,76 @@
 #ifndef PATH_HPP_
 #define PATH_HPP_
 
+#include <string>
+
 class Path {
  public:
   /**
-   * user.csv path
+   * the default data directory, every path below lies in it
+   */
+  static const char *dataPath;
+
+  /**
+   * move a path from the default data directory to another one, so several
+   * storages may each keep their files in their own directory
+   * @param t_directory the data directory, the default one if empty
+   * @param t_path a path in the default data directory
+   * @return the path in the data directory
+   */
+  static std::string in(const std::string &t_directory, const char *t_path);
+
+  /**
+   * users directory path, it holds one csv file per partition of the users
    */
   static const char *userPath;
 
   /**
-   * meeting.csv path
+   * meetings directory path, it holds one csv file per partition of the
+   * meetings, which are placed by their sponsors
    */
   static const char *meetingPath;
 
+  /**
+   * the number of partitions in each directory
+   */
+  static const int partitions;
+
+  /**
+   * users.csv path, a single user file read in place of the partitions when
+   * found, like one edited by hand or left by an older version
+   */
+  static const char *userImportPath;
+
+  /**
+   * meetings.csv path, the single meeting file read along with users.csv
+   */
+  static const char *meetingImportPath;
+
+  /**
+   * journal.log path
+   */
+  static const char *journalPath;
+
+  /**
+   * manifest path, names the last committed pair of csv files
+   */
+  static const char *manifestPath;
+
+  /**
+   * agenda.snap path, the binary snapshot of the csv files
+   */
+  static const char *snapshotPath;
+
+  /**
+   * agenda.bin path, the tables of the binary engine
+   */
+  static const char *binaryPath;
+
+  /**
+   * agenda.bin.log path, the journal of the binary engine
+   */
+  static const char *binaryJournalPath;
+
   /**
    * log.txt path
    */
@@ -0,0 +1,106 @@
+#ifndef RECORD_HPP_
+#define RECORD_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Meeting.hpp"
+#include "User.hpp"
+
+/**
+ * the text form of users and meetings, one line of quoted fields each, as
+ * the csv files and the journal store them:
+ *   "<username>","<password>","<email>","<phone>"
+ *   "<sponsor>","<participators>","<start date>","<end date>","<title>"
+ */
+class Record {
+ public:
+  /**
+   * take the next line out of a file content
+   * @param t_content the rest of the content, the line is removed from it
+   * @param t_line the line without its '\n'
+   * @return if there was a line left, true will be returned
+   */
+  static bool nextLine(std::string_view &t_content, std::string_view &t_line);
+
+  /**
+   * split a line of quoted, non-empty fields: "<f1>","<f2>",...
+   * @param t_line the source line
+   * @param t_fields the fields found
+   * @param t_count the number of fields expected
+   * @param t_allowEmpty if empty fields are accepted
+   * @return if the line has the expected format, true will be returned
+   */
+  static bool split(std::string_view t_line, std::string_view *t_fields,
+                    std::size_t t_count, bool t_allowEmpty = false);
+
+  /**
+   * build a user from the fields of a record
+   * @param t_fields <username>,<password>,<email>,<phone>
+   * @return the user
+   */
+  static User parseUser(const std::string_view *t_fields);
+
+  /**
+   * build a meeting from the fields of a record
+   * @param t_fields <sponsor>,<participators>,<start date>,<end date>,<title>
+   * @param t_at the position of the record, appended to error messages
+   * @return the meeting
+   */
+  static Meeting parseMeeting(const std::string_view *t_fields,
+                              const std::string &t_at);
+
+  /**
+   * read a user record
+   * @param t_line the line of the record
+   * @param t_at the position of the record, appended to error messages
+   * @return the user
+   */
+  static User readUser(std::string_view t_line, const std::string &t_at);
+
+  /**
+   * read a meeting record
+   * @param t_line the line of the record
+   * @param t_at the position of the record, appended to error messages
+   * @return the meeting
+   */
+  static Meeting readMeeting(std::string_view t_line,
+                             const std::string &t_at);
+
+  /**
+   * append a user as a record, formatted in place without temporaries
+   * @param t_out the buffer
+   * @param t_user the source user
+   */
+  static void append(std::string &t_out, const User &t_user);
+
+  /**
+   * append a meeting as a record, formatted in place without temporaries
+   * @param t_out the buffer
+   * @param t_meeting the source meeting
+   */
+  static void append(std::string &t_out, const Meeting &t_meeting);
+
+  /**
+   * encode a user as a record
+   * @param t_user the source user
+   * @return the record, without '\n'
+   */
+  static std::string encode(const User &t_user);
+
+  /**
+   * encode a meeting as a record
+   * @param t_meeting the source meeting
+   * @return the record, without '\n'
+   */
+  static std::string encode(const Meeting &t_meeting);
+
+  /**
+   * encode the key of a journal record
+   * @param t_key the username or title
+   * @return the quoted key
+   */
+  static std::string quote(const std::string &t_key);
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef SLAB_HPP_
+#define SLAB_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * records kept in one contiguous array and addressed by integer handles.
+ * Erasing leaves a tombstone so the other handles stay valid, compact()
+ * reclaims the tombstones and renumbers the live records in order
+ */
+template <typename T>
+class Slab {
+ public:
+  typedef std::uint32_t Handle;
+
+  /**
+   * a handle that never names a record
+   */
+  static const Handle npos = static_cast<Handle>(-1);
+
+  Slab() : m_tombstones(0) {}
+
+  /**
+   * append a record
+   * @param t_record the record to copy in
+   * @return the handle of the new record
+   */
+  Handle insert(const T &t_record) {
+    this->m_records.push_back(t_record);
+    this->m_live.push_back(1);
+
+    return static_cast<Handle>(this->m_records.size() - 1);
+  }
+
+  /**
+   * append a record
+   * @param t_record the record to move in
+   * @return the handle of the new record
+   */
+  Handle insert(T &&t_record) {
+    this->m_records.push_back(std::move(t_record));
+    this->m_live.push_back(1);
+
+    return static_cast<Handle>(this->m_records.size() - 1);
+  }
+
+  /**
+   * make room for records before appending them
+   * @param t_slots the number of slots to hold
+   */
+  void reserve(std::size_t t_slots) {
+    this->m_records.reserve(t_slots);
+    this->m_live.reserve(t_slots);
+  }
+
+  /**
+   * erase a record and leave a tombstone in its slot
+   * @param t_handle the handle of a live record
+   */
+  void erase(Handle t_handle) {
+    // drop the payload now, only the slot waits for compaction
+    this->m_records[t_handle] = T();
+    this->m_live[t_handle] = 0;
+    ++this->m_tombstones;
+  }
+
+  /**
+   * put a record back into the tombstone it was erased from
+   * @param t_handle the handle of a tombstone
+   * @param t_record the record to copy in
+   */
+  void revive(Handle t_handle, const T &t_record) {
+    this->m_records[t_handle] = t_record;
+    this->m_live[t_handle] = 1;
+    --this->m_tombstones;
+  }
+
+  /**
+   * @param t_handle any handle
+   * @return if the handle names a live record, true will be returned
+   */
+  bool contains(Handle t_handle) const {
+    return t_handle < this->m_live.size() && this->m_live[t_handle];
+  }
+
+  T &operator[](Handle t_handle) { return this->m_records[t_handle]; }
+
+  const T &operator[](Handle t_handle) const {
+    return this->m_records[t_handle];
+  }
+
+  /**
+   * @return the number of live records
+   */
+  std::size_t size(void) const {
+    return this->m_records.size() - this->m_tombstones;
+  }
+
+  /**
+   * @return the number of slots, live or not. Handles are below it
+   */
+  std::size_t slots(void) const { return this->m_records.size(); }
+
+  /**
+   * @return the number of tombstones waiting for compaction
+   */
+  std::size_t tombstones(void) const { return this->m_tombstones; }
+
+  /**
+   * call a function with the handle of every live record in slot order
+   * @param t_visitor the function to call
+   */
+  template <typename F>
+  void forEach(F t_visitor) const {
+    for (std::size_t slot = 0; slot < this->m_records.size(); ++slot) {
+      if (this->m_live[slot]) t_visitor(static_cast<Handle>(slot));
+    }
+  }
+
+  /**
+   * move the live records over the tombstones, keeping their order
+   * @return the new handle of every old handle, npos for tombstones
+   */
+  std::vector<Handle> compact(void) {
+    std::vector<Handle> moved(this->m_records.size(), npos);
+    std::size_t next = 0;
+
+    for (std::size_t slot = 0; slot < this->m_records.size(); ++slot) {
+      if (!this->m_live[slot]) continue;
+
+      if (slot != next)
+        this->m_records[next] = std::move(this->m_records[slot]);
+
+      moved[slot] = static_cast<Handle>(next++);
+    }
+
+    this->m_records.resize(next);
+    this->m_live.assign(next, 1);
+    this->m_tombstones = 0;
+
+    return moved;
+  }
+
+  /**
+   * remove every record and tombstone
+   */
+  void clear(void) {
+    this->m_records.clear();
+    this->m_live.clear();
+    this->m_tombstones = 0;
+  }
+
+ private:
+  std::vector<T> m_records;
+  std::vector<unsigned char> m_live;
+  std::size_t m_tombstones;
+};
+
+template <typename T>
+const typename Slab<T>::Handle Slab<T>::npos;
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "MappedFile.hpp"
+#include "Meeting.hpp"
+#include "User.hpp"
+
+/**
+ * the binary snapshot format, every part is 8-byte aligned and stored in
+ * the byte order of the host:
+ *   Header
+ *   UserRecord[userCount]
+ *   MeetingRecord[meetingCount]
+ *   StringRef[participatorCount]   the participators of every meeting
+ *   char[stringBytes]              the string table
+ */
+namespace snapshot {
+
+const char magic[8] = {'A', 'G', 'E', 'N', 'D', 'A', 'S', 'N'};
+const std::uint32_t version = 1;
+
+struct StringRef {
+  std::uint32_t offset;
+  std::uint32_t length;
+};
+
+struct Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t userCount;
+  std::uint32_t meetingCount;
+  std::uint32_t participatorCount;
+  std::uint64_t stringBytes;
+  // the stamp of the csv files the snapshot was taken from
+  StringRef stamp;
+};
+
+struct UserRecord {
+  StringRef name;
+  StringRef password;
+  StringRef email;
+  StringRef phone;
+};
+
+struct MeetingRecord {
+  // minutes counted by Date::dateToMinutes
+  std::int64_t start;
+  std::int64_t end;
+  StringRef sponsor;
+  StringRef title;
+  std::uint32_t firstParticipator;
+  std::uint32_t participatorCount;
+};
+
+}  // namespace snapshot
+
+/**
+ * collect users and meetings and write them as a binary snapshot, equal
+ * strings are stored once in the string table
+ */
+class SnapshotWriter {
+ public:
+  /**
+   * add a user to the snapshot
+   * @param t_user the user
+   */
+  void addUser(const User &t_user);
+
+  /**
+   * add a meeting to the snapshot
+   * @param t_meeting the meeting
+   */
+  void addMeeting(const Meeting &t_meeting);
+
+  /**
+   * write the snapshot through a temporary file renamed into place
+   * @param t_path the path of the snapshot
+   * @param t_stamp the stamp of the csv files the snapshot is taken from
+   * @param t_durable if the snapshot must reach the disk
+   * @return if success, true will be returned
+   */
+  bool write(const char *t_path, const std::string &t_stamp, bool t_durable);
+
+ private:
+  /**
+   * put a string into the string table once
+   * @param t_string the string
+   * @return where the string is in the table
+   */
+  snapshot::StringRef intern(const std::string &t_string);
+
+  std::vector<snapshot::UserRecord> m_users;
+  std::vector<snapshot::MeetingRecord> m_meetings;
+  std::vector<snapshot::StringRef> m_participators;
+  std::string m_strings;
+  std::unordered_map<std::string, snapshot::StringRef> m_interned;
+};
+
+/**
+ * a binary snapshot mapped read-only into memory, its records are checked
+ * once when it is opened and then copied out one at a time. Nothing is
+ * served from the mapping once the tables are loaded
+ */
+class Snapshot {
+ public:
+  /**
+   * default constructor, maps nothing
+   */
+  Snapshot();
+
+  /**
+   * map a snapshot and check its header and records
+   * @param t_path the path of the snapshot
+   * @return if the snapshot exists and is well formed, true will be returned
+   */
+  bool open(const char *t_path);
+
+  /**
+   * @return the stamp of the csv files the snapshot was taken from
+   */
+  std::string_view stamp(void) const;
+
+  /**
+   * @return the number of users
+   */
+  std::uint32_t userCount(void) const;
+
+  /**
+   * @return the number of meetings
+   */
+  std::uint32_t meetingCount(void) const;
+
+  /**
+   * @param t_index the index of the user
+   * @return the user
+   */
+  User user(std::uint32_t t_index) const;
+
+  /**
+   * @param t_index the index of the meeting
+   * @return the meeting
+   */
+  Meeting meeting(std::uint32_t t_index) const;
+
+ private:
+  /**
+   * @param t_ref where the string is in the string table
+   * @return the string
+   */
+  std::string_view string(snapshot::StringRef t_ref) const;
+
+  MappedFile m_file;
+  const snapshot::Header *m_header;
+  const snapshot::UserRecord *m_users;
+  const snapshot::MeetingRecord *m_meetings;
+  const snapshot::StringRef *m_participators;
+  const char *m_strings;
+};
+
+#endif
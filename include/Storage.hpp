@@ -1,20 +1,108 @@
 #ifndef AGENDA_STORAGE_HPP_
 #define AGENDA_STORAGE_HPP_
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Backend.hpp"
+#include "BloomFilter.hpp"
+#include "IntervalTree.hpp"
 #include "Meeting.hpp"
 #include "Path.hpp"
+#include "Slab.hpp"
+#include "Symbols.hpp"
 #include "User.hpp"
+#include "Version.hpp"
 
 class Storage {
+ public:
+  typedef Slab<User>::Handle UserHandle;
+  typedef Slab<Meeting>::Handle MeetingHandle;
+
+  /**
+   * when written files are forced to the disk: never, on every sync, or on
+   * every few syncs. Snapshots are forced unless the policy is none
+   */
+  enum FsyncPolicy { none, perSync, batched };
+
+  /**
+   * the counters of the username filter, which answers the lookups of
+   * usernames that surely do not exist without the index
+   */
+  struct FilterStats {
+    // lookups through findUserByName and userExists
+    unsigned long long lookups;
+    // lookups the filter answered alone
+    unsigned long long rejections;
+    // lookups the filter let through for a name that does not exist
+    unsigned long long falsePositives;
+    // the share of lookups of missing names let through, measured
+    double observedRate;
+    // the same share, estimated from the size of the filter
+    double expectedRate;
+    // the bytes the filter takes
+    std::size_t bytes;
+  };
+
+  /**
+   * the memory of a storage by component, in bytes. Strings short enough
+   * to be kept in place count as part of their records
+   */
+  struct MemoryStats {
+    // the number of live users and meetings
+    std::size_t users;
+    std::size_t meetings;
+    // the slots of the record tables, tombstones included
+    std::size_t userRecords;
+    std::size_t meetingRecords;
+    // the heap payloads of the user fields and of the meeting titles
+    std::size_t userStrings;
+    std::size_t titleStrings;
+    // the participator id arrays of the meetings
+    std::size_t participators;
+    // username -> user, with its keys, and the username filter
+    std::size_t userIndex;
+    std::size_t userFilter;
+    // title -> meeting, with its keys
+    std::size_t titleIndex;
+    // user -> meetings, user -> schedule, and the calendar of all meetings
+    std::size_t meetingIndex;
+    std::size_t scheduleIndex;
+    std::size_t calendarIndex;
+    // the copies held by the last pinned version
+    std::size_t version;
+    // what the backend keeps, like the encoded records of the csv engine
+    // The interned names are shared by every storage of the process, so
+    // they are left out and told by Symbols::bytes
+    std::size_t backend;
+
+    /**
+     * @return the bytes of every component
+     */
+    std::size_t total(void) const;
+
+    /**
+     * @return the bytes of the components that grow with the meetings
+     */
+    std::size_t meetingBytes(void) const;
+  };
+
  private:
   /**
-   *   default constructor
+   *   constructor, loads the tables from the backend
+   *   @param t_backend where the tables are kept between runs
    */
-  Storage();
+  explicit Storage(std::unique_ptr<Backend> t_backend);
 
   /**
    *   disallow the copy constructor and assign operator
@@ -23,16 +111,196 @@ class Storage {
   void operator=(const Storage &t_another) = delete;
 
   /**
-   *   read file content into memory
+   *   persist the tables through the backend, which folds the journal into
+   *   the base files
    *   @return if success, true will be returned
    */
-  bool readFromFile(void);
+  bool checkpoint(void);
+
+  /**
+   *   apply a journal record to the tables
+   *   @param t_record the record
+   *   @param t_line the line number of the record in the journal
+   */
+  void replay(std::string_view t_record, int t_line);
+
+  /**
+   *   apply a switcher to a user and keep the username index in step with it
+   *   @param t_user the handle of the user
+   *   @param switcher the method to update the user
+   */
+  void switchUser(UserHandle t_user,
+                  const std::function<void(User &)> &switcher);
+
+  /**
+   *   add a meeting to the posting list and schedule of one user
+   *   @param t_user the sponsor or participator
+   *   @param t_meeting the handle of the meeting
+   */
+  void indexMeetingUser(Symbols::Id t_user, MeetingHandle t_meeting);
+
+  /**
+   *   remove a meeting from the posting list and schedule of one user
+   *   @param t_user the sponsor or participator
+   *   @param t_meeting the handle of the meeting
+   *   @param t_start the start minute the meeting was scheduled with
+   */
+  void unindexMeetingUser(Symbols::Id t_user, MeetingHandle t_meeting,
+                          long long t_start);
+
+  /**
+   *   add a meeting to the indexes of its sponsor and participators
+   *   @param t_meeting the handle of the meeting
+   */
+  void indexMeeting(MeetingHandle t_meeting);
+
+  /**
+   *   remove a meeting from the indexes of its sponsor and participators
+   *   @param t_meeting the handle of the meeting
+   */
+  void unindexMeeting(MeetingHandle t_meeting);
+
+  /**
+   *   apply a switcher to a meeting and move it between indexes if its
+   *   sponsor, participators or time change
+   *   @param t_meeting the handle of the meeting
+   *   @param switcher the method to update the meeting
+   */
+  void switchMeeting(MeetingHandle t_meeting,
+                     const std::function<void(Meeting &)> &switcher);
+
+  /**
+   *   update one user and log it to the journal
+   *   @param t_user the handle of the user
+   *   @param switcher the method to update the user
+   */
+  void updateUserAt(UserHandle t_user,
+                    const std::function<void(User &)> &switcher);
+
+  /**
+   *   delete one user and log it to the journal
+   *   @param t_user the handle of the user
+   */
+  void deleteUserAt(UserHandle t_user);
+
+  /**
+   *   add a user to the username index and filter
+   *   @param t_user the handle of the user
+   */
+  void indexUser(UserHandle t_user);
+
+  /**
+   *   remove a user from the username index, and rebuild the filter once
+   *   the names of deleted users outnumber the live ones
+   *   @param t_user the handle of the user
+   */
+  void unindexUser(UserHandle t_user);
+
+  /**
+   *   size the username filter for twice the users and fill it again
+   */
+  void rebuildUserFilter(void);
+
+  /**
+   *   check the username filter before the index, and count its answers
+   *   @param t_userName the username to look up
+   *   @return if the user may exist, true will be returned
+   */
+  bool mightBeUser(const std::string &t_userName) const;
+
+  /**
+   *   log a mutation to the journal, or hold it back until the running
+   *   transaction commits
+   *   @param t_record the journal record
+   */
+  void log(std::string t_record);
+
+  /**
+   *   update one meeting and log it to the journal
+   *   @param t_meeting the handle of the meeting
+   *   @param switcher the method to update the meeting
+   */
+  void updateMeetingAt(MeetingHandle t_meeting,
+                       const std::function<void(Meeting &)> &switcher);
+
+  /**
+   *   delete one meeting and log it to the journal
+   *   @param t_meeting the handle of the meeting
+   */
+  void deleteMeetingAt(MeetingHandle t_meeting);
+
+  /**
+   *   @param t_userName the sponsor or participator
+   *   @return the meetings of the user, or nullptr if the user has none
+   */
+  const std::vector<MeetingHandle> *postingsOf(
+      const std::string &t_userName) const;
+
+  /**
+   *   rebuild every index from the record slabs
+   */
+  void rebuildIndexes(void);
+
+  /**
+   *   compact the slabs once tombstones outnumber the live records
+   */
+  void compactIfSparse(void);
+
+  /**
+   *   reclaim the tombstones left by deletions and rebuild the indexes
+   */
+  void reclaimTombstones(void);
+
+  /**
+   *   mark the version chunk holding a user as written, and tell the
+   *   backend the record changed
+   *   @param t_user the handle of the user
+   */
+  void touchUser(UserHandle t_user);
 
   /**
-   *   write file content from memory
+   *   mark the version chunk holding a meeting as written, and tell the
+   *   backend the record changed
+   *   @param t_meeting the handle of the meeting
+   */
+  void touchMeeting(MeetingHandle t_meeting);
+
+  /**
+   *   mark every version chunk as written, after the handles were renumbered
+   */
+  void touchAll(void);
+
+  /**
+   *   write the buffered journal records to the file, or fold the journal
+   *   into the base files once it is long. The file is written after the
+   *   table lock is released
+   *   @param t_force if the records are forced to the disk whatever the
+   *   fsync policy, unless it is none
    *   @return if success, true will be returned
    */
-  bool writeToFile(void);
+  bool commit(bool t_force);
+
+  /**
+   *   count journal records buffered since the last commit, and wake the
+   *   flusher once there are enough of them
+   *   @param t_records the number of new records
+   */
+  void countUnflushed(std::size_t t_records);
+
+  /**
+   *   the loop of the flusher thread
+   */
+  void runFlusher(void);
+
+  /**
+   *   @return a shared lock on the tables, held only in concurrent mode
+   */
+  std::shared_lock<std::shared_mutex> readLock(void) const;
+
+  /**
+   *   @return an exclusive lock on the tables, held only in concurrent mode
+   */
+  std::unique_lock<std::shared_mutex> writeLock(void);
 
  public:
   /**
@@ -41,6 +309,30 @@ class Storage {
    */
   static std::shared_ptr<Storage> getInstance(void);
 
+  /**
+   * choose the backend of the instances created from now on, the csv
+   * engine by default. Pick it at startup, before the first getInstance
+   * @param t_factory makes the backend of an instance
+   */
+  static void setBackend(
+      std::function<std::unique_ptr<Backend>(void)> t_factory);
+
+  /**
+   * make an instance of its own, apart from the one of getInstance, so one
+   * process can keep the tables of several data directories
+   * @param t_backend where the tables are kept between runs
+   * @return the pointer of the instance
+   */
+  static std::shared_ptr<Storage> open(std::unique_ptr<Backend> t_backend);
+
+  /**
+   * the partition a username falls in, users are placed by their names and
+   * meetings by their sponsors
+   * @param t_userName the username
+   * @return the number of the partition, below Path::partitions
+   */
+  static int partitionOf(const std::string &t_userName);
+
   /**
    *   destructor
    */
@@ -78,6 +370,50 @@ class Storage {
    */
   int deleteUser(std::function<bool(const User &)> filter);
 
+  /**
+   * visit every user without copying it
+   * @param visitor a lambda function called with each user
+   */
+  void forEachUser(std::function<void(const User &)> visitor) const;
+
+  /**
+   * find the first fitted user, the scan stops there
+   * @param a lambda function as the filter
+   * @return the stored user, or nullptr if none fits. The pointer is
+   * invalidated by the next mutation of the user table
+   */
+  const User *firstUser(std::function<bool(const User &)> filter) const;
+
+  /**
+   * check if any user fits, the scan stops at the first one
+   * @param a lambda function as the filter
+   * @return if a user fits, true will be returned
+   */
+  bool anyUser(std::function<bool(const User &)> filter) const;
+
+  /**
+   * count the fitted users without copying them
+   * @param a lambda function as the filter
+   * @return the number of fitted users
+   */
+  int countUsers(std::function<bool(const User &)> filter) const;
+
+  /**
+   * find a user by its name through the username filter and index, a name
+   * the filter surely lacks never reaches the index
+   * @param t_userName the username to look up
+   * @return the stored user, or nullptr if no such user. The pointer is
+   * invalidated by the next mutation of the user table
+   */
+  const User *findUserByName(const std::string &t_userName) const;
+
+  /**
+   * check if a user exists through the username filter and index
+   * @param t_userName the username to look up
+   * @return if the user exists, true will be returned
+   */
+  bool userExists(const std::string &t_userName) const;
+
   /**
    * create a meeting
    * @param a meeting object
@@ -109,14 +445,622 @@ class Storage {
   int deleteMeeting(std::function<bool(const Meeting &)> filter);
 
   /**
-   * sync with the file
+   * visit every meeting without copying it
+   * @param visitor a lambda function called with each meeting
+   */
+  void forEachMeeting(std::function<void(const Meeting &)> visitor) const;
+
+  /**
+   * find the first fitted meeting, the scan stops there
+   * @param a lambda function as the filter
+   * @return the stored meeting, or nullptr if none fits. The pointer is
+   * invalidated by the next mutation of the meeting table
+   */
+  const Meeting *firstMeeting(
+      std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * check if any meeting fits, the scan stops at the first one
+   * @param a lambda function as the filter
+   * @return if a meeting fits, true will be returned
+   */
+  bool anyMeeting(std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * count the fitted meetings without copying them
+   * @param a lambda function as the filter
+   * @return the number of fitted meetings
+   */
+  int countMeetings(std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * query the meetings a user sponsors or takes part in
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return a list of fitted meetings
+   */
+  std::list<Meeting> queryMeeting(
+      const std::string &t_userName,
+      std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * update the meetings a user sponsors or takes part in
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @param a lambda function as the method to update the meeting
+   * @return the number of updated meetings
+   */
+  int updateMeeting(const std::string &t_userName,
+                    std::function<bool(const Meeting &)> filter,
+                    std::function<void(Meeting &)> switcher);
+
+  /**
+   * delete the meetings a user sponsors or takes part in
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return the number of deleted meetings
+   */
+  int deleteMeeting(const std::string &t_userName,
+                    std::function<bool(const Meeting &)> filter);
+
+  /**
+   * visit every meeting of a user without copying it
+   * @param t_userName the sponsor or participator
+   * @param visitor a lambda function called with each meeting
+   */
+  void forEachMeeting(const std::string &t_userName,
+                      std::function<void(const Meeting &)> visitor) const;
+
+  /**
+   * find the first fitted meeting of a user, the scan stops there
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return the stored meeting, or nullptr if none fits. The pointer is
+   * invalidated by the next mutation of the meeting table
+   */
+  const Meeting *firstMeeting(
+      const std::string &t_userName,
+      std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * check if any meeting of a user fits, the scan stops at the first one
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return if a meeting fits, true will be returned
+   */
+  bool anyMeeting(const std::string &t_userName,
+                  std::function<bool(const Meeting &)> filter) const;
+
+  /**
+   * count the fitted meetings of a user without copying them
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return the number of fitted meetings
+   */
+  int countMeetings(const std::string &t_userName,
+                    std::function<bool(const Meeting &)> filter) const;
+
+  // The same methods taking the filter, switcher or visitor type directly,
+  // so a lambda is inlined into the scan instead of being called through a
+  // std::function for every record. A lambda argument picks these, and the
+  // std::function overloads above forward here
+
+  template <typename Filter>
+  std::list<User> queryUser(Filter &&filter) const {
+    auto lock = this->readLock();
+    std::list<User> result;
+
+    this->m_users.forEach([this, &filter, &result](UserHandle user) {
+      if (filter(this->m_users[user])) result.push_back(this->m_users[user]);
+    });
+
+    return result;
+  }
+
+  template <typename Filter, typename Switcher>
+  int updateUser(Filter &&filter, Switcher &&switcher) {
+    auto lock = this->writeLock();
+
+    // only the matched users pay for the indirect call
+    const std::function<void(User &)> apply = std::ref(switcher);
+    int count = 0;
+
+    for (UserHandle user = 0; user < this->m_users.slots(); ++user) {
+      if (this->m_users.contains(user) && filter(this->m_users[user])) {
+        this->updateUserAt(user, apply);
+        ++count;
+      }
+    }
+
+    if (count) this->m_dirty = true;
+
+    return count;
+  }
+
+  template <typename Filter>
+  int deleteUser(Filter &&filter) {
+    auto lock = this->writeLock();
+    int removed = 0;
+
+    for (UserHandle user = 0; user < this->m_users.slots(); ++user) {
+      if (this->m_users.contains(user) && filter(this->m_users[user])) {
+        this->deleteUserAt(user);
+        ++removed;
+      }
+    }
+
+    if (removed) {
+      this->m_dirty = true;
+      this->compactIfSparse();
+    }
+
+    return removed;
+  }
+
+  template <typename Visitor>
+  void forEachUser(Visitor &&visitor) const {
+    auto lock = this->readLock();
+
+    this->m_users.forEach(
+        [this, &visitor](UserHandle user) { visitor(this->m_users[user]); });
+  }
+
+  template <typename Filter>
+  const User *firstUser(Filter &&filter) const {
+    auto lock = this->readLock();
+
+    for (UserHandle user = 0; user < this->m_users.slots(); ++user) {
+      if (this->m_users.contains(user) && filter(this->m_users[user]))
+        return &this->m_users[user];
+    }
+
+    return nullptr;
+  }
+
+  template <typename Filter>
+  bool anyUser(Filter &&filter) const {
+    return this->firstUser<Filter &>(filter) != nullptr;
+  }
+
+  template <typename Filter>
+  int countUsers(Filter &&filter) const {
+    auto lock = this->readLock();
+    int count = 0;
+
+    this->m_users.forEach([this, &filter, &count](UserHandle user) {
+      if (filter(this->m_users[user])) ++count;
+    });
+
+    return count;
+  }
+
+  template <typename Filter>
+  std::list<Meeting> queryMeeting(Filter &&filter) const {
+    auto lock = this->readLock();
+    std::list<Meeting> result;
+
+    this->m_meetings.forEach([this, &filter, &result](MeetingHandle meeting) {
+      if (filter(this->m_meetings[meeting]))
+        result.push_back(this->m_meetings[meeting]);
+    });
+
+    return result;
+  }
+
+  template <typename Filter, typename Switcher>
+  int updateMeeting(Filter &&filter, Switcher &&switcher) {
+    auto lock = this->writeLock();
+
+    const std::function<void(Meeting &)> apply = std::ref(switcher);
+    int count = 0;
+
+    for (MeetingHandle meeting = 0; meeting < this->m_meetings.slots();
+         ++meeting) {
+      if (this->m_meetings.contains(meeting) &&
+          filter(this->m_meetings[meeting])) {
+        this->updateMeetingAt(meeting, apply);
+        ++count;
+      }
+    }
+
+    if (count) this->m_dirty = true;
+
+    return count;
+  }
+
+  template <typename Filter>
+  int deleteMeeting(Filter &&filter) {
+    auto lock = this->writeLock();
+    int removed = 0;
+
+    for (MeetingHandle meeting = 0; meeting < this->m_meetings.slots();
+         ++meeting) {
+      if (this->m_meetings.contains(meeting) &&
+          filter(this->m_meetings[meeting])) {
+        this->deleteMeetingAt(meeting);
+        ++removed;
+      }
+    }
+
+    if (removed) {
+      this->m_dirty = true;
+      this->compactIfSparse();
+    }
+
+    return removed;
+  }
+
+  template <typename Visitor>
+  void forEachMeeting(Visitor &&visitor) const {
+    auto lock = this->readLock();
+
+    this->m_meetings.forEach([this, &visitor](MeetingHandle meeting) {
+      visitor(this->m_meetings[meeting]);
+    });
+  }
+
+  template <typename Filter>
+  const Meeting *firstMeeting(Filter &&filter) const {
+    auto lock = this->readLock();
+
+    for (MeetingHandle meeting = 0; meeting < this->m_meetings.slots();
+         ++meeting) {
+      if (this->m_meetings.contains(meeting) &&
+          filter(this->m_meetings[meeting]))
+        return &this->m_meetings[meeting];
+    }
+
+    return nullptr;
+  }
+
+  template <typename Filter>
+  bool anyMeeting(Filter &&filter) const {
+    return this->firstMeeting<Filter &>(filter) != nullptr;
+  }
+
+  template <typename Filter>
+  int countMeetings(Filter &&filter) const {
+    auto lock = this->readLock();
+    int count = 0;
+
+    this->m_meetings.forEach([this, &filter, &count](MeetingHandle meeting) {
+      if (filter(this->m_meetings[meeting])) ++count;
+    });
+
+    return count;
+  }
+
+  template <typename Filter>
+  std::list<Meeting> queryMeeting(const std::string &t_userName,
+                                  Filter &&filter) const {
+    auto lock = this->readLock();
+    std::list<Meeting> result;
+    const std::vector<MeetingHandle> *postings = this->postingsOf(t_userName);
+
+    if (postings == nullptr) return result;
+
+    for (MeetingHandle meeting : *postings) {
+      if (filter(this->m_meetings[meeting]))
+        result.push_back(this->m_meetings[meeting]);
+    }
+
+    return result;
+  }
+
+  template <typename Filter, typename Switcher>
+  int updateMeeting(const std::string &t_userName, Filter &&filter,
+                    Switcher &&switcher) {
+    auto lock = this->writeLock();
+    const std::vector<MeetingHandle> *entry = this->postingsOf(t_userName);
+
+    if (entry == nullptr) return 0;
+
+    // the switcher may move meetings out of this posting list
+    std::vector<MeetingHandle> postings = *entry;
+    const std::function<void(Meeting &)> apply = std::ref(switcher);
+    int count = 0;
+
+    for (MeetingHandle meeting : postings) {
+      if (filter(this->m_meetings[meeting])) {
+        this->updateMeetingAt(meeting, apply);
+        ++count;
+      }
+    }
+
+    if (count) this->m_dirty = true;
+
+    return count;
+  }
+
+  template <typename Filter>
+  int deleteMeeting(const std::string &t_userName, Filter &&filter) {
+    auto lock = this->writeLock();
+    const std::vector<MeetingHandle> *entry = this->postingsOf(t_userName);
+
+    if (entry == nullptr) return 0;
+
+    std::vector<MeetingHandle> postings = *entry;
+    int removed = 0;
+
+    for (MeetingHandle meeting : postings) {
+      if (filter(this->m_meetings[meeting])) {
+        this->deleteMeetingAt(meeting);
+        ++removed;
+      }
+    }
+
+    if (removed) {
+      this->m_dirty = true;
+      this->compactIfSparse();
+    }
+
+    return removed;
+  }
+
+  template <typename Visitor>
+  void forEachMeeting(const std::string &t_userName,
+                      Visitor &&visitor) const {
+    auto lock = this->readLock();
+    const std::vector<MeetingHandle> *postings = this->postingsOf(t_userName);
+
+    if (postings == nullptr) return;
+
+    for (MeetingHandle meeting : *postings) visitor(this->m_meetings[meeting]);
+  }
+
+  template <typename Filter>
+  const Meeting *firstMeeting(const std::string &t_userName,
+                              Filter &&filter) const {
+    auto lock = this->readLock();
+    const std::vector<MeetingHandle> *postings = this->postingsOf(t_userName);
+
+    if (postings == nullptr) return nullptr;
+
+    for (MeetingHandle meeting : *postings) {
+      if (filter(this->m_meetings[meeting])) return &this->m_meetings[meeting];
+    }
+
+    return nullptr;
+  }
+
+  template <typename Filter>
+  bool anyMeeting(const std::string &t_userName, Filter &&filter) const {
+    return this->firstMeeting<Filter &>(t_userName, filter) != nullptr;
+  }
+
+  template <typename Filter>
+  int countMeetings(const std::string &t_userName, Filter &&filter) const {
+    int count = 0;
+
+    this->forEachMeeting(t_userName, [&filter, &count](const Meeting &meeting) {
+      if (filter(meeting)) ++count;
+    });
+
+    return count;
+  }
+
+  /**
+   * find a meeting by its title through the title index
+   * @param t_title the title to look up
+   * @return the stored meeting, or nullptr if no such meeting. The pointer is
+   * invalidated by the next mutation of the meeting table
+   */
+  const Meeting *findMeetingByTitle(const std::string &t_title) const;
+
+  /**
+   * update the meeting with a title
+   * @param t_title the title to look up
+   * @param a lambda function as the method to update the meeting
+   * @return the number of updated meetings
+   */
+  int updateMeetingByTitle(const std::string &t_title,
+                           std::function<void(Meeting &)> switcher);
+
+  /**
+   * delete the meeting with a title
+   * @param t_title the title to look up
+   * @return the number of deleted meetings
+   */
+  int deleteMeetingByTitle(const std::string &t_title);
+
+  /**
+   * find a meeting of a user overlapping a time interval
+   * @param t_userName the sponsor or participator
+   * @param t_startDate the start of the interval
+   * @param t_endDate the end of the interval, excluded
+   * @return the earliest overlapping meeting, or nullptr if the user is free
+   */
+  const Meeting *findTimeConflict(const std::string &t_userName,
+                                  const Date &t_startDate,
+                                  const Date &t_endDate) const;
+
+  /**
+   * query the meetings overlapping a time interval
+   * @param t_startDate the start of the interval
+   * @param t_endDate the end of the interval, included
+   * @return the meetings in the order of their start dates
+   */
+  std::list<Meeting> queryMeeting(const Date &t_startDate,
+                                  const Date &t_endDate) const;
+
+  /**
+   * query the meetings of a user overlapping a time interval
+   * @param t_userName the sponsor or participator
+   * @param t_startDate the start of the interval
+   * @param t_endDate the end of the interval, included
+   * @return the meetings in the order of their start dates
+   */
+  std::list<Meeting> queryMeeting(const std::string &t_userName,
+                                  const Date &t_startDate,
+                                  const Date &t_endDate) const;
+
+  /**
+   * reclaim the tombstones left by deletions and rebuild the indexes. The
+   * query, update and delete methods never observe tombstones, so this only
+   * changes memory use and handles
+   */
+  void compact(void);
+
+  /**
+   * sync with the file, which flushes the journal of the mutations and
+   * folds it into the base files once it is long
+   * @return if success, true will be returned
    */
   bool sync(void);
 
+  /**
+   * measure the memory of the tables, their indexes and caches. It visits
+   * every record, so it costs about as much as a full scan
+   * @return the bytes of each component
+   */
+  MemoryStats memoryStats(void) const;
+
+  /**
+   * report how well the username filter spares the index
+   * @return the counters of the filter
+   */
+  FilterStats filterStats(void) const;
+
+  /**
+   * start a thread that commits the journal in the background, every
+   * interval or as soon as enough records are waiting. The mutations only
+   * buffer their records, and the ones made while a commit is written go
+   * out together with the next. It turns on concurrent mode, see
+   * setConcurrent
+   * @param t_interval the longest a record waits for a commit
+   * @param t_threshold the number of waiting records that starts a commit
+   */
+  void startFlusher(std::chrono::milliseconds t_interval,
+                    std::size_t t_threshold = 1024);
+
+  /**
+   * stop the flusher thread after a last commit
+   */
+  void stopFlusher(void);
+
+  /**
+   * wait until the mutations made so far are on disk. With the flusher
+   * running, the callers waiting at the same time share one commit
+   * @return if success, true will be returned
+   */
+  bool flush(void);
+
+  /**
+   * choose when the written files are forced to the disk
+   * @param t_policy none, perSync or batched
+   * @param t_batch the number of syncs in a batch
+   */
+  void setFsyncPolicy(FsyncPolicy t_policy, int t_batch = 32);
+
+  /**
+   * run several mutations as one unit. The body calls the methods of this
+   * storage as usual; if it throws, every mutation it made is undone and
+   * the exception passes on, otherwise they reach the journal together and
+   * are replayed all or none. In concurrent mode the body holds the
+   * exclusive lock throughout, so its checks and writes are atomic. A
+   * transaction started inside another one joins it. sync, compaction and
+   * the snapshot commands wait until the outermost one ends
+   * @param t_body a lambda function doing the mutations
+   */
+  void transaction(const std::function<void(void)> &t_body);
+
+  /**
+   * pin the current version of the tables. It never changes and needs no
+   * lock, so a long read on it neither sees nor blocks later writes. Only
+   * the chunks written since the last pinned version are copied
+   * @return the version, released when its last holder drops it
+   */
+  std::shared_ptr<const Version> pinVersion(void);
+
+  /**
+   * choose if the instance is shared between threads. In concurrent mode the
+   * queries hold a shared lock and the mutations and sync an exclusive one,
+   * so the filters, switchers and visitors must not call back into the
+   * storage, and a returned pointer is only safe to read until another
+   * thread mutates the tables. Set it before the instance is shared
+   * @param t_concurrent if the tables are locked
+   */
+  void setConcurrent(bool t_concurrent);
+
+  /**
+   * write the tables to the binary snapshot, after folding the journal into
+   * the csv files so the snapshot is taken from them. From then on every
+   * checkpoint refreshes the snapshot, and starts read it instead of the csv
+   * files while it matches them. Only the csv engine keeps a snapshot
+   * @return if success, true will be returned
+   */
+  bool exportSnapshot(void);
+
+  /**
+   * replace the tables with the binary snapshot and write them to the csv
+   * files
+   * @return if success, true will be returned
+   */
+  bool importSnapshot(void);
+
  private:
   static std::shared_ptr<Storage> m_instance;
-  std::list<User> m_userList;
-  std::list<Meeting> m_meetingList;
+  // guards the lazy creation of the instance
+  static std::mutex m_instanceMutex;
+  // makes the backend of the next instance
+  static std::function<std::unique_ptr<Backend>(void)> m_backendFactory;
+  // readers share it and writers own it, in concurrent mode only
+  mutable std::shared_mutex m_mutex;
+  bool m_concurrent;
+  // the thread running a transaction, which already holds the lock
+  std::atomic<std::thread::id> m_owner;
+  bool m_inTransaction;
+  // how to take back each mutation of the transaction, and its journal
+  // records
+  std::vector<std::function<void(void)>> m_undo;
+  std::vector<std::string> m_pending;
+  // keeps the journal writes, which run outside the table lock, in order
+  std::mutex m_ioMutex;
+  // the flusher thread and what it waits on
+  std::thread m_flusher;
+  std::mutex m_flushMutex;
+  std::condition_variable m_flushCondition;
+  std::chrono::milliseconds m_flushInterval;
+  std::atomic<std::size_t> m_flushThreshold;
+  bool m_flusherStopping;
+  // the last flush() ticket handed out and the last one committed
+  unsigned long long m_flushRequested;
+  unsigned long long m_flushCompleted;
+  bool m_flushSucceeded;
+  // journal records buffered since the last commit
+  std::atomic<std::size_t> m_unflushed;
+  // the last pinned version, which of its chunks were written since, and
+  // if any was
+  std::shared_ptr<const Version> m_version;
+  std::vector<unsigned char> m_staleUsers;
+  std::vector<unsigned char> m_staleMeetings;
+  bool m_versionStale;
+  // guards the version state above, as pinning runs under the shared lock
+  mutable std::mutex m_versionMutex;
+  Slab<User> m_users;
+  Slab<Meeting> m_meetings;
+  // username -> user, usernames are unique
+  std::unordered_map<std::string, UserHandle> m_userIndex;
+  // the usernames, and the names of users deleted since it was rebuilt
+  BloomFilter m_userFilter;
+  mutable std::atomic<unsigned long long> m_filterLookups;
+  mutable std::atomic<unsigned long long> m_filterRejections;
+  mutable std::atomic<unsigned long long> m_filterFalsePositives;
+  // title -> meeting, titles are unique
+  std::unordered_map<std::string, MeetingHandle> m_titleIndex;
+  // user id -> meetings the user sponsors or takes part in, only users
+  // with meetings here have an entry, as the ids are shared by the process
+  std::unordered_map<Symbols::Id, std::vector<MeetingHandle>> m_meetingIndex;
+  // user id -> [start, end) of the meetings the user is busy with
+  std::unordered_map<Symbols::Id, IntervalTree<MeetingHandle>>
+      m_scheduleIndex;
+  // [start, end) of every meeting
+  IntervalTree<MeetingHandle> m_calendarIndex;
+  // loads and persists the tables, and keeps the mutations logged since
+  std::unique_ptr<Backend> m_backend;
+  FsyncPolicy m_fsyncPolicy;
+  int m_fsyncBatch;
+  int m_unsyncedSyncs;
   bool m_dirty;
 };
 
@@ -0,0 +1,76 @@
+#ifndef SYMBOLS_HPP_
+#define SYMBOLS_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * the table interning usernames as dense 32-bit ids, so ids are compared in
+ * place of the names. Every meeting holding an id holds a reference to it,
+ * and a name is taken out once the last reference goes, its id given to the
+ * next new name. An id names the same string for as long as it is held, and
+ * reading the name of a held id takes no lock. Id 0 is the empty name,
+ * which is never taken out
+ */
+class Symbols {
+ public:
+  typedef std::uint32_t Id;
+
+  /**
+   * the id of the empty name
+   */
+  static constexpr Id empty = 0;
+
+  /**
+   * an id no name has, which takes part in no meeting
+   */
+  static constexpr Id none = 0xffffffff;
+
+  /**
+   * get the id of a name and a reference to it, adding the name if it is
+   * new
+   * @param t_name the name
+   * @return the id, to be released by the holder
+   */
+  static Id intern(std::string_view t_name);
+
+  /**
+   * take one more reference to a held id
+   * @param t_id the id
+   */
+  static void retain(Id t_id);
+
+  /**
+   * drop a reference to an id, the name goes once nobody holds it
+   * @param t_id the id
+   */
+  static void release(Id t_id);
+
+  /**
+   * look up the id of a name without adding it or holding it. The id may
+   * only be compared with the ids held meanwhile
+   * @param t_name the name
+   * @return the id, or none if the name is not found
+   */
+  static Id find(std::string_view t_name);
+
+  /**
+   * @param t_id a held id
+   * @return the name of the id
+   */
+  static const std::string &name(Id t_id);
+
+  /**
+   * @return the number of names held, the empty one included
+   */
+  static std::size_t size(void);
+
+  /**
+   * @return the bytes the names and their lookup table take
+   */
+  static std::size_t bytes(void);
+};
+
+#endif
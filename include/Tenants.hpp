@@ -0,0 +1,110 @@
+#ifndef TENANTS_HPP_
+#define TENANTS_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "Storage.hpp"
+
+/**
+ * the storages of many tenants hosted in one process, each kept in a data
+ * directory of its own under a root directory. A tenant is loaded when it
+ * is first opened, and evicted once nobody holds it and it has been idle
+ * for long enough, which persists its tables and frees their memory. The
+ * storages are opened in concurrent mode, as a host shares them between
+ * threads
+ */
+class Tenants {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * the memory of one tenant
+   */
+  struct Usage {
+    std::string tenant;
+    // if the tables are loaded
+    bool resident;
+    // the total of Storage::memoryStats, measured now if the tables are
+    // loaded, or else when they were evicted
+    std::size_t bytes;
+    // the time since the tenant was last opened
+    Clock::duration idle;
+  };
+
+  /**
+   * constructor, no tenant is loaded until it is opened
+   * @param t_root the directory holding a data directory per tenant
+   * @param t_engine the storage engine of every tenant, see Backend::create
+   */
+  explicit Tenants(const std::string &t_root,
+                   const std::string &t_engine = "csv");
+
+  /**
+   * disallow the copy constructor and assign operator
+   */
+  Tenants(const Tenants &t_another) = delete;
+  void operator=(const Tenants &t_another) = delete;
+
+  /**
+   * get the storage of a tenant, loading it if it is not resident. A new
+   * tenant starts with empty tables
+   * @param t_tenant the name of the tenant, which names its directory
+   * @return the storage, or nullptr if the name is not a plain directory
+   * name, free of blanks and control characters, or the engine does not
+   * exist
+   */
+  std::shared_ptr<Storage> open(const std::string &t_tenant);
+
+  /**
+   * evict the tenants nobody else holds and nobody opened for a while
+   * @param t_idle how long a tenant must have been idle
+   * @return the number of tenants evicted
+   */
+  std::size_t evictIdle(Clock::duration t_idle);
+
+  /**
+   * @return the number of tenants whose tables are loaded
+   */
+  std::size_t resident(void) const;
+
+  /**
+   * measure the memory of every tenant opened so far
+   * @return the usage of each tenant
+   */
+  std::vector<Usage> usage(void) const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<Storage> storage;
+    Clock::time_point lastOpened;
+    std::size_t bytes = 0;
+  };
+
+  /**
+   * wait until a tenant is neither being loaded nor evicted
+   * @param t_lock the lock on the registry
+   * @param t_tenant the name of the tenant
+   */
+  void waitIdle(std::unique_lock<std::mutex> &t_lock,
+                const std::string &t_tenant);
+
+  std::string m_root;
+  std::string m_engine;
+  // guards the entries and the busy tenants
+  mutable std::mutex m_mutex;
+  // notified whenever a tenant stops being busy
+  std::condition_variable m_idle;
+  // tenant -> its storage, evicted tenants stay with no storage
+  std::unordered_map<std::string, Entry> m_tenants;
+  // the tenants being loaded or evicted outside the lock
+  std::unordered_set<std::string> m_busy;
+};
+
+#endif
@@ -21,11 +21,26 @@ class User {
    */
   User(const User &t_user);
 
+  /**
+   * @brief move constructor
+   */
+  User(User &&t_user) = default;
+
+  /**
+   * @brief copy assignment
+   */
+  User &operator=(const User &t_user) = default;
+
+  /**
+   * @brief move assignment
+   */
+  User &operator=(User &&t_user) = default;
+
   /**
    * @brief get the name of the user
    * @return   return a string indicate the name of the user
    */
-  std::string getName() const;
+  const std::string &getName() const;
 
   /**
    * @brief set the name of the user
@@ -37,7 +52,7 @@ class User {
    * @brief get the password of the user
    * @return   return a string indicate the password of the user
    */
-  std::string getPassword() const;
+  const std::string &getPassword() const;
 
   /**
    * @brief set the password of the user
@@ -49,7 +64,7 @@ class User {
    * @brief get the email of the user
    * @return   return a string indicate the email of the user
    */
-  std::string getEmail() const;
+  const std::string &getEmail() const;
 
   /**
    * @brief set the email of the user
@@ -61,7 +76,7 @@ class User {
    * @brief get the phone of the user
    * @return   return a string indicate the phone of the user
    */
-  std::string getPhone() const;
+  const std::string &getPhone() const;
 
   /**
    * @brief set the phone of the user
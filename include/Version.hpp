@@ -0,0 +1,128 @@
+#ifndef VERSION_HPP_
+#define VERSION_HPP_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Meeting.hpp"
+#include "User.hpp"
+
+/**
+ * an immutable copy of the user and meeting tables at one point in time.
+ * The records are kept in chunks of consecutive handles shared between
+ * versions, so a new version copies only the chunks written since the one
+ * before it. A version stays valid for as long as someone holds it
+ */
+class Version {
+ public:
+  template <typename T>
+  using Chunk = std::shared_ptr<const std::vector<T>>;
+
+  /**
+   * the number of handles one chunk covers
+   */
+  static constexpr std::size_t chunkSize = 1024;
+
+  Version() : m_number(0), m_userCount(0), m_meetingCount(0) {}
+
+  /**
+   * @return the number of the version, later versions have larger numbers
+   */
+  unsigned long long number(void) const { return this->m_number; }
+
+  /**
+   * @return the number of users
+   */
+  std::size_t userCount(void) const { return this->m_userCount; }
+
+  /**
+   * @return the number of meetings
+   */
+  std::size_t meetingCount(void) const { return this->m_meetingCount; }
+
+  /**
+   * visit every user
+   * @param visitor a lambda function called with each user
+   */
+  template <typename Visitor>
+  void forEachUser(Visitor &&visitor) const {
+    for (const Chunk<User> &chunk : this->m_users) {
+      for (const User &user : *chunk) visitor(user);
+    }
+  }
+
+  /**
+   * visit every meeting
+   * @param visitor a lambda function called with each meeting
+   */
+  template <typename Visitor>
+  void forEachMeeting(Visitor &&visitor) const {
+    for (const Chunk<Meeting> &chunk : this->m_meetings) {
+      for (const Meeting &meeting : *chunk) visitor(meeting);
+    }
+  }
+
+  /**
+   * query users
+   * @param a lambda function as the filter
+   * @return a list of fitted users
+   */
+  template <typename Filter>
+  std::list<User> queryUser(Filter &&filter) const {
+    std::list<User> result;
+
+    this->forEachUser([&filter, &result](const User &user) {
+      if (filter(user)) result.push_back(user);
+    });
+
+    return result;
+  }
+
+  /**
+   * query meetings
+   * @param a lambda function as the filter
+   * @return a list of fitted meetings
+   */
+  template <typename Filter>
+  std::list<Meeting> queryMeeting(Filter &&filter) const {
+    std::list<Meeting> result;
+
+    this->forEachMeeting([&filter, &result](const Meeting &meeting) {
+      if (filter(meeting)) result.push_back(meeting);
+    });
+
+    return result;
+  }
+
+  /**
+   * query the meetings a user sponsors or takes part in. A version has no
+   * indexes, so this scans every meeting
+   * @param t_userName the sponsor or participator
+   * @param a lambda function as the filter
+   * @return a list of fitted meetings
+   */
+  template <typename Filter>
+  std::list<Meeting> queryMeeting(const std::string &t_userName,
+                                  Filter &&filter) const {
+    const Symbols::Id user = Symbols::find(t_userName);
+
+    return this->queryMeeting([user, &filter](const Meeting &meeting) {
+      return (meeting.getSponsorId() == user ||
+              meeting.isParticipator(user)) &&
+             filter(meeting);
+    });
+  }
+
+ private:
+  friend class Storage;
+
+  unsigned long long m_number;
+  std::size_t m_userCount;
+  std::size_t m_meetingCount;
+  std::vector<Chunk<User>> m_users;
+  std::vector<Chunk<Meeting>> m_meetings;
+};
+
+#endif
@@ -1,21 +1,82 @@
 #include <signal.h>
+#include <cstring>
 #include "AgendaUI.hpp"
+#include "Storage.hpp"
 
-AgendaUI agenda;
+/**
+ * only flag the interrupt, the operation loop saves and quits outside of
+ * the handler, where writing the files is safe
+ */
+void sig_int(int signal) { AgendaUI::interrupt(); }
 
-void sig_int(int signal) {
-  std::cout << std::endl
-            << "SIGINT received." << std::endl
-            << "All changes are saved." << std::endl;
-  agenda.quitAgenda(1);
+/**
+ * pick the storage engine before the storage is first used
+ * @param t_engine csv, binary or memory
+ * @return if the engine exists, true will be returned
+ */
+bool useEngine(const std::string &t_engine) {
+  if (Backend::create(t_engine) == nullptr) return false;
+
+  Storage::setBackend([t_engine]() { return Backend::create(t_engine); });
+
+  return true;
+}
+
+/**
+ * convert between the csv files and the binary snapshot
+ * @param t_command --export-snapshot or --import-snapshot
+ * @return the exit code
+ */
+int convert(const char *t_command) {
+  bool success = false;
+
+  if (std::strcmp(t_command, "--export-snapshot") == 0) {
+    success = Storage::getInstance()->exportSnapshot();
+  } else if (std::strcmp(t_command, "--import-snapshot") == 0) {
+    success = Storage::getInstance()->importSnapshot();
+  } else {
+    std::cerr << "Usage: Agenda [--engine csv|binary|memory] "
+                 "[--export-snapshot | --import-snapshot]"
+              << std::endl;
+    return 2;
+  }
+
+  if (!success) std::cerr << t_command << " failed" << std::endl;
+
+  return success ? 0 : 1;
 }
 
-int main() {
-  if (signal(SIGINT, sig_int) == SIG_ERR)
+int main(int argc, char *argv[]) {
+  if (argc > 2 && std::strcmp(argv[1], "--engine") == 0) {
+    if (!useEngine(argv[2])) return convert(argv[1]);
+
+    argc -= 2;
+    argv += 2;
+  }
+
+  if (argc > 1) return convert(argv[1]);
+
+  // quitAgenda leaves through exit, which still destroys statics
+  static AgendaUI agenda;
+  struct sigaction action;
+
+  action.sa_handler = sig_int;
+  sigemptyset(&action.sa_mask);
+  // without SA_RESTART the blocking read of the operation loop returns
+  action.sa_flags = 0;
+
+  if (sigaction(SIGINT, &action, nullptr) < 0)
     std::cout << "Warning: signal handler for SIGINT isn't set properly"
               << std::endl;
 
   agenda.OperationLoop();
 
+  if (AgendaUI::interrupted())
+    std::cout << std::endl
+              << "SIGINT received." << std::endl
+              << "All changes are saved." << std::endl;
+
+  agenda.quitAgenda(AgendaUI::interrupted() ? 1 : 0);
+
   return 0;
-}
\ No newline at end of file
+}
@@ -1,17 +1,88 @@
 #include "AgendaService.hpp"
 #include <algorithm>
+#include <unordered_map>
 #include "Exception.hpp"
 
-using std::find;
 using std::list;
 using std::string;
 using std::vector;
 
+/**
+ * parse and check the dates of a new meeting
+ * @param startDate the meeting's start date
+ * @param endDate the meeting's end date
+ * @param sDate set to the parsed start date
+ * @param eDate set to the parsed end date
+ */
+static void checkDates(const string &startDate, const string &endDate,
+                       Date &sDate, Date &eDate) {
+  sDate = Date::stringToDate(startDate);
+  eDate = Date::stringToDate(endDate);
+
+  // check if dates valid
+  if (!Date::isValid(sDate)) throw invalid_date("Start date: " + startDate);
+
+  if (!Date::isValid(eDate)) throw invalid_date("End date: " + endDate);
+
+  if (sDate >= eDate)
+    throw invalid_date("Start date must be earlier than end date");
+}
+
+/**
+ * check the sponsor and participators of a new meeting
+ * @param userName the sponsor's userName
+ * @param participator the meeting's participator
+ * @param exists tells if a user exists
+ */
+template <typename Exists>
+static void checkAttendees(const string &userName,
+                           const vector<string> &participator,
+                           Exists &&exists) {
+  // check if sponsor exists
+  if (!exists(userName)) throw user_not_found("Sponsor: " + userName);
+
+  for (auto it = participator.begin(); it != participator.end(); it++) {
+    // check if sponsor is one of participators
+    if (userName == *it)
+      throw user_repeat("Sponsor: " + userName + " is found in participators");
+
+    // check if participator exists
+    if (!exists(*it)) throw user_not_found("Participator: " + *it);
+
+    // check if participator repeats
+    for (auto itInner = participator.begin(); itInner != it; itInner++) {
+      if (*itInner == *it)
+        throw user_repeat("Participator: " + *it + " appears more than once");
+    }
+  }
+}
+
+/**
+ * @param who the busy sponsor or participator
+ * @param startDate the start of the meeting keeping it busy
+ * @param endDate the end of the meeting keeping it busy
+ * @return the message of a time conflict
+ */
+static string busy(const string &who, const Date &startDate,
+                   const Date &endDate) {
+  return who + " is busy from " + Date::dateToString(startDate) + " to " +
+         Date::dateToString(endDate);
+}
+
 /**
  * constructor
  */
 AgendaService::AgendaService() { this->startAgenda(); };
 
+/**
+ * constructor, serving the tables of a storage of its own
+ * @param t_storage the storage
+ */
+AgendaService::AgendaService(std::shared_ptr<Storage> t_storage)
+    : m_storage(std::move(t_storage)) {
+  this->startAgenda();
+}
+
 /**
  * destructor
  */
@@ -24,11 +95,9 @@ AgendaService::~AgendaService() { this->quitAgenda(); }
  * @return if success, true will be returned
  */
 bool AgendaService::userLogIn(const string &userName, const string &password) {
-  auto filter = [&userName, &password](const User &u) -> bool {
-    return u.getName() == userName && u.getPassword() == password;
-  };
+  const User *user = this->m_storage->findUserByName(userName);
 
-  if (this->m_storage->queryUser(filter).empty())
+  if (user == nullptr || user->getPassword() != password)
     throw user_not_found("User: " + userName);
 
   return true;
@@ -44,11 +113,7 @@ bool AgendaService::userLogIn(const string &userName, const string &password) {
  */
 bool AgendaService::userRegister(const string &userName, const string &password,
                                  const string &email, const string &phone) {
-  auto filter = [&userName](const User &u) -> bool {
-    return u.getName() == userName;
-  };
-
-  if (!this->m_storage->queryUser(filter).empty())
+  if (this->m_storage->userExists(userName))
     throw user_repeat("Username: " + userName + " is taken by others");
 
   this->m_storage->createUser(User(userName, password, email, phone));
@@ -63,20 +128,30 @@ bool AgendaService::userRegister(const string &userName, const string &password,
  * @return if success, true will be returned
  */
 bool AgendaService::deleteUser(const string &userName, const string &password) {
-  auto filterUserExist = [&userName, &password](const User &u) -> bool {
-    return u.getName() == userName && u.getPassword() == password;
-  };
+  // the user and its meetings go together or not at all
+  this->m_storage->transaction([&]() {
+    auto filterUserExist = [&userName, &password](const User &u) -> bool {
+      return u.getName() == userName && u.getPassword() == password;
+    };
 
-  if (this->m_storage->deleteUser(filterUserExist) == 0)
-    throw user_not_found("User: " + userName);
+    if (this->m_storage->deleteUser(filterUserExist) == 0)
+      throw user_not_found("User: " + userName);
 
-  this->m_storage->updateMeeting(
-      [&userName](const Meeting &m) -> bool {
-        return m.isParticipator(userName);
-      },
-      [&userName](Meeting &m) { m.removeParticipator(userName); });
-  this->m_storage->deleteMeeting([&userName](const Meeting &m) -> bool {
-    return m.getSponsor() == userName || m.getParticipator().empty();
+    // drop the meetings the user sponsors or would leave without participators
+    // first, they fall out of the user's posting list once the user is removed
+    const Symbols::Id user = Symbols::find(userName);
+
+    this->m_storage->deleteMeeting(userName, [user](const Meeting &m) {
+      if (m.getSponsorId() == user) return true;
+
+      const vector<Symbols::Id> &participators = m.getParticipatorIds();
+
+      return participators.size() == 1 && participators.front() == user;
+    });
+    this->m_storage->updateMeeting(
+        userName,
+        [user](const Meeting &m) -> bool { return m.isParticipator(user); },
+        [&userName](Meeting &m) { m.removeParticipator(userName); });
   });
 
   return true;
@@ -105,96 +180,121 @@ bool AgendaService::createMeeting(const string &userName, const string &title,
                                   const string &startDate,
                                   const string &endDate,
                                   const vector<string> &participator) {
-  Date sDate = Date::stringToDate(startDate);
-  Date eDate = Date::stringToDate(endDate);
+  Date sDate, eDate;
 
-  // check if dates valid
-  if (!Date::isValid(sDate)) throw invalid_date("Start date: " + startDate);
+  checkDates(startDate, endDate, sDate, eDate);
 
-  if (!Date::isValid(eDate)) throw invalid_date("End date: " + endDate);
+  // the checks and the write run in one transaction, so in concurrent mode
+  // no other thread takes the title or the time in between
+  this->m_storage->transaction([&]() {
+    checkAttendees(userName, participator, [this](const string &name) {
+      return this->m_storage->userExists(name);
+    });
 
-  if (sDate >= eDate)
-    throw invalid_date("Start date must be earlier than end date");
+    const Meeting *sameTitle = this->m_storage->findMeetingByTitle(title);
 
-  auto filterSponsorExist = [&userName](const User &u) -> bool {
-    return u.getName() == userName;
-  };
+    // check if title is repeated
+    if (sameTitle != nullptr)
+      throw title_repeat("Meeting sponsored by " + sameTitle->getSponsor() +
+                         " has a same title");
 
-  // check if sponsor exists
-  if (this->m_storage->queryUser(filterSponsorExist).empty())
-    throw user_not_found("Sponsor: " + userName);
+    // check if sponsor is busy
+    const Meeting *conflict =
+        this->m_storage->findTimeConflict(userName, sDate, eDate);
 
-  for (auto it = participator.begin(); it != participator.end(); it++) {
-    // check if sponsor is one of participators
-    if (userName == *it)
-      throw user_repeat("Sponsor: " + userName + " is found in participators");
+    if (conflict != nullptr)
+      throw time_conflict(busy("Sponsor: " + userName,
+                               conflict->getStartDate(),
+                               conflict->getEndDate()));
 
-    string part = *it;
+    // check if any participator is busy
+    for (const string &part : participator) {
+      conflict = this->m_storage->findTimeConflict(part, sDate, eDate);
 
-    auto filterParticipatorExist = [&part](const User &u) -> bool {
-      return u.getName() == part;
-    };
+      if (conflict != nullptr)
+        throw time_conflict(busy("Participator: " + part,
+                                 conflict->getStartDate(),
+                                 conflict->getEndDate()));
+    }
 
-    // check if participator exists
-    if (this->m_storage->queryUser(filterParticipatorExist).empty())
-      throw user_not_found("Participator: " + *it);
+    this->m_storage->createMeeting(
+        Meeting(userName, participator, sDate, eDate, title));
+  });
 
-    // check if participator repeats
-    for (auto itInner = participator.begin(); itInner != it; itInner++) {
-      if (*itInner == *it)
-        throw user_repeat("Participator: " + *it + " appears more than once");
-    }
-  }
+  return true;
+}
 
-  auto filterOverlapAndBusy = [&userName, &title, &sDate, &eDate,
-                               &participator](const Meeting &m) -> bool {
-    // check if title is repeated
-    if (m.getTitle() == title)
-      throw title_repeat("Meeting sponsored by " + m.getSponsor() +
-                         " has a same title");
+/**
+ * create many meetings at once, as if createMeeting were called on each in
+ * turn
+ * @param batch the meetings to create
+ * @return the outcome of each meeting, in the order of the batch
+ */
+vector<AgendaService::MeetingResult> AgendaService::createMeetings(
+    const vector<MeetingRequest> &batch) {
+  vector<MeetingResult> results(batch.size(), MeetingResult{false, "", ""});
 
-    // check if sponsor is busy
-    if (m.getSponsor() == userName || m.isParticipator(userName)) {
-      bool isBusy = false;
+  // the checks and the writes run in one transaction, so nothing changes in
+  // between and the created meetings are journaled in one write. Each
+  // meeting is created as soon as it passes, so the indexes of the storage
+  // check the later ones against it
+  this->m_storage->transaction([&]() {
+    std::unordered_map<string, bool> users;
 
-      if (m.getStartDate() <= sDate && m.getEndDate() > sDate) isBusy = true;
+    auto exists = [this, &users](const string &name) {
+      auto user = users.find(name);
 
-      if (m.getStartDate() < eDate && m.getEndDate() >= eDate) isBusy = true;
+      if (user == users.end())
+        user = users.emplace(name, this->m_storage->userExists(name)).first;
 
-      if (m.getStartDate() >= sDate && m.getEndDate() <= eDate) isBusy = true;
+      return user->second;
+    };
 
-      if (isBusy)
-        throw time_conflict("Sponsor: " + userName + " is busy from " +
-                            Date::dateToString(m.getStartDate()) + " to " +
-                            Date::dateToString(m.getEndDate()));
-    }
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      const MeetingRequest &request = batch[i];
 
-    // check if any participator is busy
-    for (const string &part : participator) {
-      if (m.getSponsor() == part || m.isParticipator(part)) {
-        bool isBusy = false;
+      try {
+        Date sDate, eDate;
 
-        if (m.getStartDate() <= sDate && m.getEndDate() > sDate) isBusy = true;
+        checkDates(request.startDate, request.endDate, sDate, eDate);
+        checkAttendees(request.sponsor, request.participator, exists);
 
-        if (m.getStartDate() < eDate && m.getEndDate() >= eDate) isBusy = true;
+        const Meeting *sameTitle =
+            this->m_storage->findMeetingByTitle(request.title);
 
-        if (m.getStartDate() >= sDate && m.getEndDate() <= eDate) isBusy = true;
+        if (sameTitle != nullptr)
+          throw title_repeat("Meeting sponsored by " +
+                             sameTitle->getSponsor() + " has a same title");
 
-        if (isBusy)
-          throw time_conflict("Participator: " + part + " is busy from " +
-                              Date::dateToString(m.getStartDate()) + " to " +
-                              Date::dateToString(m.getEndDate()));
-      }
-    }
+        const Meeting *conflict = this->m_storage->findTimeConflict(
+            request.sponsor, sDate, eDate);
 
-    return false;
-  };
+        if (conflict != nullptr)
+          throw time_conflict(busy("Sponsor: " + request.sponsor,
+                                   conflict->getStartDate(),
+                                   conflict->getEndDate()));
 
-  this->m_storage->queryMeeting(filterOverlapAndBusy);
-  this->m_storage->createMeeting(
-      Meeting(userName, (participator), startDate, endDate, title));
+        for (const string &part : request.participator) {
+          conflict = this->m_storage->findTimeConflict(part, sDate, eDate);
 
-  return true;
+          if (conflict != nullptr)
+            throw time_conflict(busy("Participator: " + part,
+                                     conflict->getStartDate(),
+                                     conflict->getEndDate()));
+        }
+
+        this->m_storage->createMeeting(
+            Meeting(request.sponsor, request.participator, sDate, eDate,
+                    request.title));
+        results[i].created = true;
+      } catch (const my_exception &e) {
+        results[i].error = e.type();
+        results[i].message = e.what();
+      }
+    }
+  });
+
+  return results;
 }
 
 /**
@@ -207,52 +307,27 @@ bool AgendaService::createMeeting(const string &userName, const string &title,
 bool AgendaService::addMeetingParticipator(const std::string &userName,
                                            const std::string &title,
                                            const std::string &participator) {
-  auto filterMeetingExist = [&userName, &title](const Meeting &m) -> bool {
-    if (m.getTitle() == title && m.getSponsor() == userName) return true;
-    return false;
-  };
-  auto meetings = this->m_storage->queryMeeting(filterMeetingExist);
+  this->m_storage->transaction([&]() {
+    const Meeting *meeting = this->m_storage->findMeetingByTitle(title);
 
-  if (meetings.empty())
-    throw meeting_not_found("Title: " + title + ". Sponsor: " + userName);
+    if (meeting == nullptr || meeting->getSponsor() != userName)
+      throw meeting_not_found("Title: " + title + ". Sponsor: " + userName);
 
-  auto filterParticipatorExist = [&participator](const User &u) -> bool {
-    return u.getName() == participator;
-  };
+    if (!this->m_storage->userExists(participator))
+      throw user_not_found("Participator: " + participator);
 
-  if (this->m_storage->queryUser(filterParticipatorExist).empty())
-    throw user_not_found("Participator: " + participator);
-
-  auto meeting = meetings.front();
-  auto filterOverlap = [&participator, &meeting](const Meeting &m) -> bool {
-    if (m.getSponsor() == participator || m.isParticipator(participator)) {
-      bool isBusy = false;
-
-      if (m.getStartDate() <= meeting.getStartDate() &&
-          m.getEndDate() > meeting.getStartDate())
-        isBusy = true;
-      if (m.getStartDate() < meeting.getEndDate() &&
-          m.getEndDate() >= meeting.getEndDate())
-        isBusy = true;
-      if (m.getStartDate() >= meeting.getStartDate() &&
-          m.getEndDate() <= meeting.getEndDate())
-        isBusy = true;
-
-      if (isBusy)
-        throw time_conflict("Participator: " + participator + " is busy from " +
-                            Date::dateToString(m.getStartDate()) + " to " +
-                            Date::dateToString(m.getEndDate()));
-    }
+    const Meeting *conflict = this->m_storage->findTimeConflict(
+        participator, meeting->getStartDate(), meeting->getEndDate());
 
-    return false;
-  };
+    if (conflict != nullptr)
+      throw time_conflict(busy("Participator: " + participator,
+                               conflict->getStartDate(),
+                               conflict->getEndDate()));
 
-  this->m_storage->queryMeeting(filterOverlap);
-  this->m_storage->updateMeeting(
-      [&meeting](const Meeting &m) {
-        return m.getTitle() == meeting.getTitle();
-      },
-      [&participator](Meeting &m) { m.addParticipator(participator); });
+    this->m_storage->updateMeetingByTitle(title, [&participator](Meeting &m) {
+      m.addParticipator(participator);
+    });
+  });
 
   return true;
 }
@@ -267,34 +342,21 @@ bool AgendaService::addMeetingParticipator(const std::string &userName,
 bool AgendaService::removeMeetingParticipator(const std::string &userName,
                                               const std::string &title,
                                               const std::string &participator) {
-  auto filterMeetingExist = [&userName, &title](const Meeting &m) -> bool {
-    if (m.getTitle() == title && m.getSponsor() == userName) return true;
-    return false;
-  };
-  auto meetings = this->m_storage->queryMeeting(filterMeetingExist);
+  this->m_storage->transaction([&]() {
+    const Meeting *meeting = this->m_storage->findMeetingByTitle(title);
 
-  if (meetings.empty())
-    throw meeting_not_found("Title: " + title + ". Sponsor: " + userName);
+    if (meeting == nullptr || meeting->getSponsor() != userName)
+      throw meeting_not_found("Title: " + title + ". Sponsor: " + userName);
 
-  auto filterParticipatorExist = [&participator](const User &u) -> bool {
-    return u.getName() == participator;
-  };
+    if (!meeting->isParticipator(participator))
+      throw user_not_found("Participator: " + participator);
 
-  auto meeting = meetings.front();
-  auto participators = meeting.getParticipator();
-
-  if (find(participators.begin(), participators.end(), participator) ==
-      participators.end())
-    throw user_not_found("Participator: " + participator);
-
-  this->m_storage->updateMeeting(
-      [&meeting](const Meeting &m) {
-        if (m.getTitle() == meeting.getTitle()) return true;
-        return false;
-      },
-      [&participator](Meeting &m) { m.removeParticipator(participator); });
-  this->m_storage->deleteMeeting([&meeting](const Meeting &m) {
-    return m.getParticipator().empty() && m.getTitle() == meeting.getTitle();
+    this->m_storage->updateMeetingByTitle(
+        title,
+        [&participator](Meeting &m) { m.removeParticipator(participator); });
+
+    if (this->m_storage->findMeetingByTitle(title)->getParticipator().empty())
+      this->m_storage->deleteMeetingByTitle(title);
   });
 
   return true;
@@ -309,24 +371,19 @@ bool AgendaService::removeMeetingParticipator(const std::string &userName,
  */
 bool AgendaService::quitMeeting(const std::string &userName,
                                 const std::string &title) {
-  auto filterMeetingExist = [&userName, &title](const Meeting &m) -> bool {
-    return m.getTitle() == title && m.isParticipator(userName);
-  };
-  auto meetings = this->m_storage->queryMeeting(filterMeetingExist);
+  this->m_storage->transaction([&]() {
+    const Meeting *meeting = this->m_storage->findMeetingByTitle(title);
 
-  // check if meeting exists
-  if (meetings.empty())
-    throw meeting_not_found("Title: " + title + ". Participator: " + userName);
+    // check if meeting exists
+    if (meeting == nullptr || !meeting->isParticipator(userName))
+      throw meeting_not_found("Title: " + title +
+                              ". Participator: " + userName);
 
-  Meeting meeting = meetings.front();
+    this->m_storage->updateMeetingByTitle(
+        title, [&userName](Meeting &m) { m.removeParticipator(userName); });
 
-  this->m_storage->updateMeeting(
-      [&meeting](const Meeting &m) -> bool {
-        return m.getTitle() == meeting.getTitle();
-      },
-      [&userName](Meeting &m) { m.removeParticipator(userName); });
-  this->m_storage->deleteMeeting([&meeting](const Meeting &m) -> bool {
-    return m.getParticipator().empty() && m.getTitle() == meeting.getTitle();
+    if (this->m_storage->findMeetingByTitle(title)->getParticipator().empty())
+      this->m_storage->deleteMeetingByTitle(title);
   });
 
   return true;
@@ -340,12 +397,14 @@ bool AgendaService::quitMeeting(const std::string &userName,
  */
 list<Meeting> AgendaService::meetingQuery(const string &userName,
                                           const string &title) const {
-  auto filter = [&userName, &title](const Meeting &m) -> bool {
-    return (m.getSponsor() == userName || m.isParticipator(userName)) &&
-           m.getTitle() == title;
-  };
+  list<Meeting> result;
+  const Meeting *meeting = this->m_storage->findMeetingByTitle(title);
 
-  return this->m_storage->queryMeeting(filter);
+  if (meeting != nullptr && (meeting->getSponsor() == userName ||
+                             meeting->isParticipator(userName)))
+    result.push_back(*meeting);
+
+  return result;
 }
 
 /**
@@ -370,12 +429,7 @@ list<Meeting> AgendaService::meetingQuery(const string &userName,
   if (sDate > eDate)
     throw invalid_date("Start date must be earlier than end date");
 
-  auto filter = [&userName, &sDate, &eDate](const Meeting &m) -> bool {
-    return !(eDate < m.getStartDate() || sDate > m.getEndDate()) &&
-           (m.getSponsor() == userName || m.isParticipator(userName));
-  };
-
-  return this->m_storage->queryMeeting(filter);
+  return this->m_storage->queryMeeting(userName, sDate, eDate);
 }
 
 /**
@@ -384,11 +438,9 @@ list<Meeting> AgendaService::meetingQuery(const string &userName,
  * @return a meeting list result
  */
 list<Meeting> AgendaService::listAllMeetings(const string &userName) const {
-  auto filter = [&userName](const Meeting &m) -> bool {
-    return m.getSponsor() == userName || m.isParticipator(userName);
-  };
+  auto filter = [](const Meeting &) -> bool { return true; };
 
-  return this->m_storage->queryMeeting(filter);
+  return this->m_storage->queryMeeting(userName, filter);
 }
 
 /**
@@ -398,11 +450,13 @@ list<Meeting> AgendaService::listAllMeetings(const string &userName) const {
  */
 list<Meeting> AgendaService::listAllSponsorMeetings(
     const string &userName) const {
+  // the names are compared, an id looked up before the storage is locked
+  // may be given to another name meanwhile
   auto filter = [&userName](const Meeting &m) -> bool {
     return m.getSponsor() == userName;
   };
 
-  return this->m_storage->queryMeeting(filter);
+  return this->m_storage->queryMeeting(userName, filter);
 }
 
 /**
@@ -416,7 +470,7 @@ list<Meeting> AgendaService::listAllParticipateMeetings(
     return m.isParticipator(userName);
   };
 
-  return this->m_storage->queryMeeting(filter);
+  return this->m_storage->queryMeeting(userName, filter);
 }
 
 /**
@@ -426,11 +480,10 @@ list<Meeting> AgendaService::listAllParticipateMeetings(
  * @return if success, true will be returned
  */
 bool AgendaService::deleteMeeting(const string &userName, const string &title) {
-  auto filter = [&userName, &title](const Meeting &m) -> bool {
-    return m.getSponsor() == userName && m.getTitle() == title;
-  };
+  const Meeting *meeting = this->m_storage->findMeetingByTitle(title);
 
-  if (this->m_storage->deleteMeeting(filter) == 0)
+  if (meeting == nullptr || meeting->getSponsor() != userName ||
+      this->m_storage->deleteMeetingByTitle(title) == 0)
     throw empty_deletion("No meeting found. Title: " + title +
                          ". Sponsor: " + userName);
 
@@ -447,23 +500,41 @@ bool AgendaService::deleteAllMeetings(const string &userName) {
     return m.getSponsor() == userName;
   };
 
-  if (this->m_storage->deleteMeeting(filter) == 0)
+  if (this->m_storage->deleteMeeting(userName, filter) == 0)
     throw empty_deletion("No meeting found. Sponsor: " + userName);
 
   return true;
 }
 
+/**
+ * take a read-only view of the current version of the storage
+ * @return the view
+ */
+AgendaView AgendaService::view(void) const {
+  return AgendaView(this->m_storage->pinVersion());
+}
+
+/**
+ * measure the memory of the storage
+ * @return the bytes of each component of the storage
+ */
+Storage::MemoryStats AgendaService::memoryStats(void) const {
+  return this->m_storage->memoryStats();
+}
+
 /**
  * start Agenda service and connect to storage
  */
 void AgendaService::startAgenda(void) {
-  this->m_storage = Storage::getInstance();
+  if (this->m_storage == nullptr) this->m_storage = Storage::getInstance();
 }
 
 /**
  * quit Agenda service
  */
 void AgendaService::quitAgenda(void) {
+  if (this->m_storage == nullptr) return;
+
   this->m_storage->sync();
   this->m_storage = nullptr;
 }
\ No newline at end of file
@@ -18,6 +18,8 @@ using std::string;
 using std::to_string;
 using std::vector;
 
+volatile std::sig_atomic_t AgendaUI::m_interrupted = 0;
+
 void printManual(bool isLoggedIn) {
   for (int i = 1; i <= 37; i++) cout << "-";
   cout << "Agenda";
@@ -29,6 +31,7 @@ void printManual(bool isLoggedIn) {
     cout << "l    - log in Agenda by user name and password" << endl;
     cout << "r    - register an Agenda account" << endl;
     cout << "q    - quit Agenda" << endl;
+    cout << "ms   - show the memory the storage uses" << endl;
   } else {
     cout << "o    - log out Agenda" << endl;
     cout << "dc   - delete Agenda account" << endl;
@@ -44,6 +47,7 @@ void printManual(bool isLoggedIn) {
     cout << "qt   - query meeting by time interval" << endl;
     cout << "dm   - delete meeting by title" << endl;
     cout << "da   - delete all meetings" << endl;
+    cout << "ms   - show the memory the storage uses" << endl;
   }
 
   for (int i = 1; i <= 80; i++) cout << "-";
@@ -125,6 +129,10 @@ vector<string> getArguments(const int argNum, string prompt) {
     printPrompt(prompt);
     line = getStrippedLine();
 
+    // the input ended, or a signal interrupted the read
+    if (!cin)
+      throw wrong_arg_num(to_string(argLeft) + " args left, input closed");
+
     int argRcv = tokenize(line, result);
 
     if (argRcv > argLeft) {
@@ -158,7 +166,8 @@ AgendaUI::AgendaUI() {
 }
 
 void AgendaUI::OperationLoop() {
-  while (true) {
+  // a signal interrupts the blocking read, which fails the stream
+  while (!m_interrupted && cin) {
     try {
       string operation = this->getOperation();
 
@@ -258,6 +267,8 @@ bool AgendaUI::executeOperation(string t_operation) {
   } else if (t_operation == "da") {
     checkLoginState(true, IS_LOG_IN, t_operation);
     this->deleteAllMeetings();
+  } else if (t_operation == "ms") {
+    this->showMemoryStats();
   } else if (t_operation == "h") {
     cout << endl;
     printManual(IS_LOG_IN);
@@ -320,6 +331,16 @@ void AgendaUI::userLogOut() {
   printManual(false);
 }
 
+/**
+ * ask the operation loop to stop, safe to call from a signal handler
+ */
+void AgendaUI::interrupt(void) { m_interrupted = 1; }
+
+/**
+ * @return if the operation loop was interrupted
+ */
+bool AgendaUI::interrupted(void) { return m_interrupted != 0; }
+
 /**
  * quit the Agenda
  */
@@ -622,6 +643,44 @@ void AgendaUI::deleteAllMeetings() {
   printPrompt("delete all meetings") << "succeed!" << endl << endl;
 }
 
+/**
+ * show the memory the storage uses, by component
+ */
+void AgendaUI::showMemoryStats() {
+  Storage::MemoryStats stats = this->m_agendaService.memoryStats();
+  std::initializer_list<std::pair<const char *, std::size_t>> rows = {
+      {"user records", stats.userRecords},
+      {"meeting records", stats.meetingRecords},
+      {"user strings", stats.userStrings},
+      {"title strings", stats.titleStrings},
+      {"participators", stats.participators},
+      {"username index", stats.userIndex},
+      {"username filter", stats.userFilter},
+      {"title index", stats.titleIndex},
+      {"meeting index", stats.meetingIndex},
+      {"schedule index", stats.scheduleIndex},
+      {"calendar index", stats.calendarIndex},
+      {"pinned version", stats.version},
+      {"backend", stats.backend},
+      {"total", stats.total()}};
+
+  cout << endl;
+  printPrompt("memory") << stats.users << " users, " << stats.meetings
+                        << " meetings" << endl
+                        << endl;
+  cout << std::left << setw(20) << "component" << "bytes" << endl;
+
+  for (const auto &row : rows)
+    cout << setw(20) << row.first << row.second << endl;
+
+  if (stats.meetings != 0)
+    cout << setw(20) << "bytes per meeting"
+         << stats.meetingBytes() / stats.meetings << endl;
+
+  // shared with every storage of the process, so not part of the total
+  cout << setw(20) << "interned names" << Symbols::bytes() << endl << endl;
+}
+
 /**
  * show the meetings in the screen
  */
@@ -0,0 +1,99 @@
+#include "AgendaView.hpp"
+#include "Exception.hpp"
+
+using std::list;
+using std::string;
+
+/**
+ * constructor
+ * @param t_version the version to answer from
+ */
+AgendaView::AgendaView(std::shared_ptr<const Version> t_version)
+    : m_version(std::move(t_version)) {}
+
+/**
+ * @return the version the view answers from
+ */
+const Version &AgendaView::version(void) const { return *this->m_version; }
+
+/**
+ * list all users
+ * @return a user list result
+ */
+list<User> AgendaView::listAllUsers(void) const {
+  return this->m_version->queryUser([](const User &) { return true; });
+}
+
+/**
+ * search a meeting by username and title
+ * @param userName as a sponsor OR a participator
+ * @param title the meeting's title
+ * @return a meeting list result
+ */
+list<Meeting> AgendaView::meetingQuery(const string &userName,
+                                       const string &title) const {
+  return this->m_version->queryMeeting(
+      userName, [&title](const Meeting &m) { return m.getTitle() == title; });
+}
+
+/**
+ * search a meeting by username, time interval
+ * @param userName as a sponsor OR a participator
+ * @param startDate time interval's start date
+ * @param endDate time interval's end date
+ * @return a meeting list result
+ */
+list<Meeting> AgendaView::meetingQuery(const string &userName,
+                                       const string &startDate,
+                                       const string &endDate) const {
+  Date sDate = Date::stringToDate(startDate);
+  Date eDate = Date::stringToDate(endDate);
+
+  if (!Date::isValid(sDate)) throw invalid_date("Start date: " + startDate);
+
+  if (!Date::isValid(eDate)) throw invalid_date("End date: " + endDate);
+
+  if (sDate > eDate)
+    throw invalid_date("Start date must be earlier than end date");
+
+  return this->m_version->queryMeeting(
+      userName, [&sDate, &eDate](const Meeting &m) {
+        return !(eDate < m.getStartDate() || sDate > m.getEndDate());
+      });
+}
+
+/**
+ * list all meetings the user take part in
+ * @param userName user's username
+ * @return a meeting list result
+ */
+list<Meeting> AgendaView::listAllMeetings(const string &userName) const {
+  return this->m_version->queryMeeting(userName,
+                                       [](const Meeting &) { return true; });
+}
+
+/**
+ * list all meetings the user sponsor
+ * @param userName user's username
+ * @return a meeting list result
+ */
+list<Meeting> AgendaView::listAllSponsorMeetings(
+    const string &userName) const {
+  const Symbols::Id user = Symbols::find(userName);
+
+  return this->m_version->queryMeeting(
+      userName, [user](const Meeting &m) { return m.getSponsorId() == user; });
+}
+
+/**
+ * list all meetings the user take part in and sponsor by other
+ * @param userName user's username
+ * @return a meeting list result
+ */
+list<Meeting> AgendaView::listAllParticipateMeetings(
+    const string &userName) const {
+  const Symbols::Id user = Symbols::find(userName);
+
+  return this->m_version->queryMeeting(
+      userName, [user](const Meeting &m) { return m.isParticipator(user); });
+}
@@ -0,0 +1,1101 @@
+#include "Backend.hpp"
+#include <errno.h>
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // stat mkdir
+#include <unistd.h>    // write fsync close
+#include <algorithm>   // min max
+#include <atomic>
+#include <charconv>    // from_chars
+#include <cstdint>     // uint64_t
+#include <cstdio>      // rename remove
+#include <cstring>     // strlen
+#include <exception>   // exception_ptr
+#include <fstream>     // ifstream ofstream
+#include <thread>
+#include "Exception.hpp"
+#include "MappedFile.hpp"
+#include "Path.hpp"
+#include "Record.hpp"
+#include "Snapshot.hpp"
+
+using std::string;
+
+/**
+ * name the file of a partition
+ * @param t_directory the users or meetings directory
+ * @param t_partition the number of the partition
+ * @return the path of the file
+ */
+static string partitionPath(const string &t_directory, int t_partition) {
+  return t_directory + "/" + std::to_string(t_partition) + ".csv";
+}
+
+/**
+ * stamp a file with its size and modification time
+ * @param t_path the path of the file
+ * @return the stamp, "-" if there is no such file
+ */
+static string fileStamp(const string &t_path) {
+  struct stat status;
+
+  if (stat(t_path.c_str(), &status) < 0) return "-";
+
+  return std::to_string(status.st_size) + ":" +
+         std::to_string(status.st_mtim.tv_sec) + "." +
+         std::to_string(status.st_mtim.tv_nsec);
+}
+
+/**
+ * stamp the files to import with their sizes and modification times
+ * @param t_directory the data directory
+ * @return the stamps, of users.csv and meetings.csv, or none if neither
+ * file is found
+ */
+static std::vector<string> importStamps(const string &t_directory) {
+  std::vector<string> stamps = {
+      fileStamp(Path::in(t_directory, Path::userImportPath)),
+      fileStamp(Path::in(t_directory, Path::meetingImportPath))};
+
+  if (stamps[0] == "-" && stamps[1] == "-") stamps.clear();
+
+  return stamps;
+}
+
+/**
+ * hash bytes alike on every platform, unlike std::hash
+ * @param t_data the bytes
+ * @return the FNV-1a hash
+ */
+static std::uint64_t fnv1a(std::string_view t_data) {
+  std::uint64_t hash = 14695981039346656037ull;
+
+  for (unsigned char c : t_data) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
+
+/**
+ * stamp a file with its size and a hash of its content, which unlike its
+ * modification time survives a copy
+ * @param t_path the path of the file
+ * @return the stamp, "-" if there is no such file
+ */
+static string contentStamp(const string &t_path) {
+  struct stat status;
+
+  if (stat(t_path.c_str(), &status) < 0) return "-";
+
+  MappedFile file;
+  std::string_view content;
+
+  if (file.open(t_path.c_str())) content = file.content();
+
+  return std::to_string(content.size()) + ":" + std::to_string(fnv1a(content));
+}
+
+/**
+ * stamp the base files of a generation, the partitions are only ever
+ * replaced through a manifest
+ * @param t_generation the generation of the manifest
+ * @return the stamp
+ */
+static string generationStamp(unsigned long long t_generation) {
+  return "generation " + std::to_string(t_generation);
+}
+
+/**
+ * stamp the base files, a journal is only replayed on top of the files it
+ * was started for. The stamp is read from what the files hold, never from
+ * their metadata, so a copied data directory keeps its journal
+ * @param t_directory the data directory
+ * @param t_imported if the base files are the files to import instead of
+ * the partitions
+ * @param t_generation the generation of the partitions
+ * @return the stamp of the base files
+ */
+static string baseStamp(const string &t_directory, bool t_imported,
+                        unsigned long long t_generation) {
+  if (t_imported)
+    return "import " +
+           contentStamp(Path::in(t_directory, Path::userImportPath)) + " " +
+           contentStamp(Path::in(t_directory, Path::meetingImportPath));
+
+  return generationStamp(t_generation);
+}
+
+/**
+ * @param t_stamp a stamp of base files
+ * @param t_generation set to the generation the stamp names
+ * @return if it is the stamp of a generation, true will be returned
+ */
+static bool generationOf(std::string_view t_stamp,
+                         unsigned long long &t_generation) {
+  const std::string_view prefix = "generation ";
+
+  if (t_stamp.substr(0, prefix.size()) != prefix) return false;
+
+  const char *first = t_stamp.data() + prefix.size();
+  const char *last = t_stamp.data() + t_stamp.size();
+  auto result = std::from_chars(first, last, t_generation);
+
+  return result.ec == std::errc() && result.ptr == last && first != last;
+}
+
+/**
+ * @param t_stamp the stamp of other base files
+ * @param t_generation the generation of the current partitions
+ * @return if the stamp names files the current ones replaced, true will be
+ * returned
+ */
+static bool olderStamp(std::string_view t_stamp,
+                       unsigned long long t_generation) {
+  unsigned long long generation;
+
+  // files to import are dropped by the first manifest after them
+  if (t_stamp.substr(0, 7) == "import ") return true;
+
+  return generationOf(t_stamp, generation) && generation < t_generation;
+}
+
+/**
+ * name the temporary file a snapshot generation writes before its commit
+ * @param t_path the path of the file
+ * @param t_generation the generation of the snapshot
+ * @return the path of the temporary file
+ */
+static string tempPath(const string &t_path, unsigned long long t_generation) {
+  return t_path + "." + std::to_string(t_generation) + ".tmp";
+}
+
+/**
+ * wait until a file is on disk
+ * @param t_path the path of the file
+ * @return if success, true will be returned
+ */
+static bool syncFile(const string &t_path) {
+  int fd = ::open(t_path.c_str(), O_RDONLY);
+
+  if (fd < 0) return false;
+
+  bool success = fsync(fd) == 0;
+
+  ::close(fd);
+
+  return success;
+}
+
+/**
+ * wait until the entries of the directory holding a file are on disk, so
+ * renames into it survive a crash
+ * @param t_path the path of the file
+ * @return if success, true will be returned
+ */
+static bool syncDirectory(const string &t_path) {
+  size_t slash = t_path.rfind('/');
+
+  return syncFile(slash == string::npos ? "." : t_path.substr(0, slash));
+}
+
+/**
+ * @param t_directory the data directory, the default one if empty
+ * @param t_path a path in the data directory
+ * @return the name the manifest keeps the path under, relative to the data
+ * directory so the directory itself may hold any character
+ */
+static string manifestName(const string &t_directory, const string &t_path) {
+  const std::size_t root =
+      t_directory.empty() ? std::strlen(Path::dataPath) : t_directory.size();
+
+  return t_path.substr(root + 1);
+}
+
+/**
+ * move the files of the snapshot named by the manifest into place, a crash
+ * after the manifest was committed leaves some of them temporary. The
+ * import files the snapshot replaced are removed after them
+ * @param t_directory the data directory
+ * @param t_durable if the renames must reach the disk
+ * @param t_generation set to the generation of the manifest, 0 without one
+ * @return if every file named is in place, true will be returned
+ */
+static bool commitSnapshot(const string &t_directory, bool t_durable,
+                           unsigned long long &t_generation) {
+  std::ifstream manifest(Path::in(t_directory, Path::manifestPath));
+  const string root = t_directory.empty() ? Path::dataPath : t_directory;
+  string line;
+
+  // <generation>, then "write <name> <size>" for every file written and
+  // "drop <name> <stamp>" for every import file replaced, one to a line.
+  // The name lies between the first space and the last one
+  t_generation = 0;
+  if (!std::getline(manifest, line)) return true;
+
+  auto result =
+      std::from_chars(line.data(), line.data() + line.size(), t_generation);
+
+  if (result.ec != std::errc()) return true;
+
+  bool success = true;
+  bool renamed = false;
+  bool dropped = false;
+
+  while (std::getline(manifest, line)) {
+    const std::size_t first = line.find(' ');
+    const std::size_t last = line.rfind(' ');
+
+    if (first == string::npos || first == last) continue;
+
+    const string action = line.substr(0, first);
+    const string path = root + "/" + line.substr(first + 1, last - first - 1);
+    const string value = line.substr(last + 1);
+    const string temp = tempPath(path, t_generation);
+    struct stat status;
+
+    if (action == "write" && stat(temp.c_str(), &status) == 0 &&
+        std::to_string(status.st_size) == value) {
+      const bool moved = std::rename(temp.c_str(), path.c_str()) == 0;
+
+      renamed |= moved;
+      success &= moved;
+    } else if (action == "drop" && fileStamp(path) == value) {
+      const bool removed = std::remove(path.c_str()) == 0;
+
+      dropped |= removed;
+      success &= removed;
+    }
+  }
+
+  if (renamed && t_durable) {
+    syncDirectory(partitionPath(Path::in(t_directory, Path::userPath), 0));
+    syncDirectory(partitionPath(Path::in(t_directory, Path::meetingPath), 0));
+  }
+
+  if (dropped && t_durable)
+    syncDirectory(Path::in(t_directory, Path::userImportPath));
+
+  return success;
+}
+
+namespace {
+
+// the size a file is cut into chunks of, each chunk ends at a line end
+const std::size_t chunkBytes = 1 << 20;
+
+/**
+ * a line-aligned piece of a CSV file, parsed by one loader thread
+ */
+template <typename T>
+struct Chunk {
+  // the index of the file in its list of paths
+  std::size_t file;
+  std::string_view content;
+  std::vector<T> records;
+  // the lines parsed, all of the chunk unless a record is bad
+  int lines = 0;
+  // the line of the first bad record in the chunk, 0 if there is none
+  int badLine = 0;
+  std::exception_ptr error;
+
+  Chunk(std::size_t t_file, std::string_view t_content)
+      : file(t_file), content(t_content) {}
+};
+
+/**
+ * cut a file into chunks of whole lines
+ * @param t_file the index of the file
+ * @param t_content the content of the file
+ * @param t_chunks the chunks, the new ones are appended in file order
+ */
+template <typename T>
+void splitFile(std::size_t t_file, std::string_view t_content,
+               std::vector<Chunk<T>> &t_chunks) {
+  while (!t_content.empty()) {
+    size_t end = t_content.size() <= chunkBytes
+                     ? std::string_view::npos
+                     : t_content.find('\n', chunkBytes);
+
+    end = end == std::string_view::npos ? t_content.size() : end + 1;
+    t_chunks.emplace_back(t_file, t_content.substr(0, end));
+    t_content.remove_prefix(end);
+  }
+}
+
+/**
+ * parse the records of a chunk. A bad record stops the chunk, its line is
+ * kept so the error can be thrown again once the line number in the file is
+ * known
+ * @param t_chunk the chunk
+ * @param t_read the function reading one record
+ */
+template <typename T>
+void parseChunk(Chunk<T> &t_chunk,
+                T (*t_read)(std::string_view, const string &)) {
+  const string unknown;
+  std::string_view content = t_chunk.content;
+  std::string_view line;
+
+  try {
+    while (Record::nextLine(content, line)) {
+      ++t_chunk.lines;
+      t_chunk.records.push_back(t_read(line, unknown));
+    }
+  } catch (const my_exception &) {
+    t_chunk.badLine = t_chunk.lines;
+  } catch (...) {
+    t_chunk.error = std::current_exception();
+  }
+}
+
+/**
+ * throw the first error of the chunks of a list of files, at the line of
+ * the bad record in its file
+ * @param t_chunks the parsed chunks, in file order
+ * @param t_paths the paths of the files
+ * @param t_read the function reading one record
+ */
+template <typename T>
+void checkChunks(const std::vector<Chunk<T>> &t_chunks,
+                 const std::vector<string> &t_paths,
+                 T (*t_read)(std::string_view, const string &)) {
+  // the lines of the file in the chunks before
+  int before = 0;
+
+  for (std::size_t i = 0; i < t_chunks.size(); ++i) {
+    const Chunk<T> &chunk = t_chunks[i];
+
+    if (i > 0 && t_chunks[i - 1].file != chunk.file) before = 0;
+
+    if (chunk.error != nullptr) std::rethrow_exception(chunk.error);
+
+    if (chunk.badLine != 0) {
+      std::string_view content = chunk.content;
+      std::string_view line;
+
+      for (int n = 0; n < chunk.badLine; ++n) Record::nextLine(content, line);
+
+      t_read(line, " at line " + std::to_string(before + chunk.badLine) +
+                       " of " + t_paths[chunk.file]);
+    }
+
+    before += chunk.lines;
+  }
+}
+
+}  // namespace
+
+/**
+ * read the partitions, or the files to import, in parallel
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ */
+void CsvBackend::readFromFile(Slab<User> &t_users, Slab<Meeting> &t_meetings) {
+  std::vector<string> userFiles, meetingFiles;
+
+  if (!this->m_importStamps.empty()) {
+    userFiles.push_back(this->path(Path::userImportPath));
+    meetingFiles.push_back(this->path(Path::meetingImportPath));
+  } else {
+    for (int partition = 0; partition < Path::partitions; ++partition) {
+      userFiles.push_back(
+          partitionPath(this->path(Path::userPath), partition));
+      meetingFiles.push_back(
+          partitionPath(this->path(Path::meetingPath), partition));
+    }
+  }
+
+  // a missing file holds no records
+  std::vector<MappedFile> files(userFiles.size() + meetingFiles.size());
+  std::vector<Chunk<User>> userChunks;
+  std::vector<Chunk<Meeting>> meetingChunks;
+
+  for (std::size_t file = 0; file < userFiles.size(); ++file) {
+    if (files[file].open(userFiles[file].c_str()))
+      splitFile(file, files[file].content(), userChunks);
+  }
+
+  for (std::size_t file = 0; file < meetingFiles.size(); ++file) {
+    MappedFile &mapped = files[userFiles.size() + file];
+
+    if (mapped.open(meetingFiles[file].c_str()))
+      splitFile(file, mapped.content(), meetingChunks);
+  }
+
+  // the user and meeting chunks are parsed side by side by a pool of
+  // loaders, then inserted in file order
+  const std::size_t chunkCount = userChunks.size() + meetingChunks.size();
+  const std::size_t loaderCount = std::min<std::size_t>(
+      std::max(std::thread::hardware_concurrency(), 1u), chunkCount);
+  std::atomic<std::size_t> next(0);
+  std::vector<std::thread> loaders;
+
+  for (std::size_t loader = 0; loader < loaderCount; ++loader)
+    loaders.emplace_back([&userChunks, &meetingChunks, &next, chunkCount]() {
+      for (std::size_t chunk; (chunk = next++) < chunkCount;) {
+        if (chunk < userChunks.size())
+          parseChunk(userChunks[chunk], Record::readUser);
+        else
+          parseChunk(meetingChunks[chunk - userChunks.size()],
+                     Record::readMeeting);
+      }
+    });
+
+  for (std::thread &loader : loaders) loader.join();
+
+  checkChunks(userChunks, userFiles, Record::readUser);
+  checkChunks(meetingChunks, meetingFiles, Record::readMeeting);
+
+  std::size_t userCount = 0, meetingCount = 0;
+
+  for (const Chunk<User> &chunk : userChunks)
+    userCount += chunk.records.size();
+
+  for (const Chunk<Meeting> &chunk : meetingChunks)
+    meetingCount += chunk.records.size();
+
+  t_users.reserve(t_users.slots() + userCount);
+  t_meetings.reserve(t_meetings.slots() + meetingCount);
+
+  for (Chunk<User> &chunk : userChunks) {
+    for (User &user : chunk.records) t_users.insert(std::move(user));
+  }
+
+  for (Chunk<Meeting> &chunk : meetingChunks) {
+    for (Meeting &meeting : chunk.records)
+      t_meetings.insert(std::move(meeting));
+  }
+
+  // the partitions are written for the first time from the import
+  const bool imported = !this->m_importStamps.empty();
+
+  this->m_dirtyUserPartitions.assign(Path::partitions, imported);
+  this->m_dirtyMeetingPartitions.assign(Path::partitions, imported);
+}
+
+/**
+ * read the tables out of a binary snapshot
+ * @param t_snapshot the open snapshot
+ * @param t_users the user table, cleared first
+ * @param t_meetings the meeting table, cleared first
+ */
+static void readSnapshot(const Snapshot &t_snapshot, Slab<User> &t_users,
+                         Slab<Meeting> &t_meetings) {
+  t_users.clear();
+  t_meetings.clear();
+  t_users.reserve(t_snapshot.userCount());
+  t_meetings.reserve(t_snapshot.meetingCount());
+
+  for (std::uint32_t user = 0; user < t_snapshot.userCount(); ++user)
+    t_users.insert(t_snapshot.user(user));
+
+  for (std::uint32_t meeting = 0; meeting < t_snapshot.meetingCount();
+       ++meeting)
+    t_meetings.insert(t_snapshot.meeting(meeting));
+}
+
+/**
+ * write the tables as a binary snapshot
+ * @param t_path the path of the snapshot
+ * @param t_stamp the stamp kept in the snapshot
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @param t_durable if the call waits until it is on disk
+ * @return if success, true will be returned
+ */
+static bool writeSnapshot(const string &t_path, const string &t_stamp,
+                          const Slab<User> &t_users,
+                          const Slab<Meeting> &t_meetings, bool t_durable) {
+  SnapshotWriter writer;
+
+  t_users.forEach([&t_users, &writer](Slab<User>::Handle user) {
+    writer.addUser(t_users[user]);
+  });
+  t_meetings.forEach([&t_meetings, &writer](Slab<Meeting>::Handle meeting) {
+    writer.addMeeting(t_meetings[meeting]);
+  });
+
+  return writer.write(t_path.c_str(), t_stamp, t_durable);
+}
+
+/**
+ * make a backend by the name of its engine
+ * @param t_engine csv, binary or memory
+ * @param t_directory the data directory, the default one if empty
+ * @return the backend, or nullptr if there is no such engine
+ */
+std::unique_ptr<Backend> Backend::create(const string &t_engine,
+                                         const string &t_directory) {
+  if (t_engine == "csv")
+    return std::unique_ptr<Backend>(new CsvBackend(t_directory));
+
+  if (t_engine == "binary")
+    return std::unique_ptr<Backend>(new BinaryBackend(t_directory));
+
+  if (t_engine == "memory") return std::unique_ptr<Backend>(new MemoryBackend);
+
+  return nullptr;
+}
+
+/**
+ * constructor
+ * @param t_directory the data directory, the default one if empty
+ */
+JournalBackend::JournalBackend(const string &t_directory)
+    : m_directory(t_directory) {}
+
+/**
+ * buffer a change record
+ * @param t_record the record, without '\n'
+ */
+void JournalBackend::append(const string &t_record) {
+  this->m_journal.append(t_record);
+}
+
+/**
+ * buffer a group of change records replayed whole or not at all
+ * @param t_records the records, without '\n'
+ */
+void JournalBackend::appendGroup(const std::vector<string> &t_records) {
+  this->m_journal.appendGroup(t_records);
+}
+
+/**
+ * @return if the journal is closed or long, true will be returned
+ */
+bool JournalBackend::full(void) const {
+  // a journal with this many records costs more to replay than to rewrite
+  const std::size_t checkpointRecords = 4096;
+
+  return !this->m_journal.isOpen() ||
+         this->m_journal.records() >= checkpointRecords;
+}
+
+/**
+ * hand over the buffered change records
+ * @return the records
+ */
+string JournalBackend::takeChanges(void) {
+  return this->m_journal.takeBuffer();
+}
+
+/**
+ * write change records taken from the buffer to the journal
+ * @param t_records the records
+ * @param t_durable if the call waits until they are on disk
+ * @return if success, true will be returned
+ */
+bool JournalBackend::writeChanges(const string &t_records,
+                                  bool t_durable) const {
+  return this->m_journal.write(t_records, t_durable);
+}
+
+/**
+ * put change records back in front of the buffer
+ * @param t_records the records
+ */
+void JournalBackend::restoreChanges(const string &t_records) {
+  this->m_journal.restoreBuffer(t_records);
+}
+
+/**
+ * the partition a username falls in
+ * @param t_userName the username, of the sponsor for a meeting
+ * @return the number of the partition
+ */
+int CsvBackend::partitionOf(const string &t_userName) {
+  return static_cast<int>(fnv1a(t_userName) % Path::partitions);
+}
+
+/**
+ * @param t_path a path under the default data directory
+ * @return the same path under the data directory of the backend
+ */
+string JournalBackend::path(const char *t_path) const {
+  return Path::in(this->m_directory, t_path);
+}
+
+/**
+ * constructor, the tables are read by load
+ * @param t_directory the data directory, the default one if empty
+ */
+CsvBackend::CsvBackend(const string &t_directory)
+    : JournalBackend(t_directory),
+      m_generation(0),
+      m_dirtyUserPartitions(Path::partitions, 0),
+      m_dirtyMeetingPartitions(Path::partitions, 0),
+      m_importStamps(importStamps(t_directory)),
+      m_snapshot(false) {}
+
+/**
+ * load the binary snapshot if it matches the csv files, or else the csv
+ * files
+ * @param t_users the user table, empty
+ * @param t_meetings the meeting table, empty
+ */
+void CsvBackend::load(Slab<User> &t_users, Slab<Meeting> &t_meetings) {
+  // a journal started after the snapshot must not meet the files before it
+  if (!commitSnapshot(this->m_directory, true, this->m_generation))
+    throw wrong_format("Snapshot not moved into place: " +
+                       this->path(Path::manifestPath));
+
+  // the files of a snapshot that never reached its commit are garbage
+  for (const char *directory : {Path::userPath, Path::meetingPath}) {
+    for (int partition = 0; partition < Path::partitions; ++partition)
+      std::remove(tempPath(partitionPath(this->path(directory), partition),
+                           this->m_generation + 1)
+                      .c_str());
+  }
+
+  if (!this->readFromSnapshot(true, t_users, t_meetings))
+    this->readFromFile(t_users, t_meetings);
+}
+
+/**
+ * replay the journal of the csv files
+ * @param t_replay called with every record and its line number
+ */
+void CsvBackend::replay(const Replayer &t_replay) {
+  const bool imported = !this->m_importStamps.empty();
+  const unsigned long long generation = this->m_generation;
+
+  // files to import replace the tables by hand, whatever they were before
+  this->m_journal.open(
+      this->path(Path::journalPath).c_str(),
+      baseStamp(this->m_directory, imported, generation), t_replay,
+      [imported, generation](std::string_view t_stamp) {
+        return imported || olderStamp(t_stamp, generation);
+      });
+}
+
+/**
+ * mark the partition of a user as changed
+ * @param t_userName the username
+ */
+void CsvBackend::markUser(const string &t_userName) {
+  this->m_dirtyUserPartitions[partitionOf(t_userName)] = 1;
+}
+
+/**
+ * mark the partition of a meeting as changed
+ * @param t_sponsor the sponsor of the meeting
+ */
+void CsvBackend::markMeeting(const string &t_sponsor) {
+  this->m_dirtyMeetingPartitions[partitionOf(t_sponsor)] = 1;
+}
+
+/**
+ * drop the encoded record of a user
+ * @param t_user the handle
+ */
+void CsvBackend::touchUser(Slab<User>::Handle t_user) {
+  if (t_user < this->m_userLines.size()) this->m_userLines[t_user].clear();
+}
+
+/**
+ * drop the encoded record of a meeting
+ * @param t_meeting the handle
+ */
+void CsvBackend::touchMeeting(Slab<Meeting>::Handle t_meeting) {
+  if (t_meeting < this->m_meetingLines.size())
+    this->m_meetingLines[t_meeting].clear();
+}
+
+/**
+ * move the encoded records along with their records
+ * @param t_lines the encoded records by old handle
+ * @param t_moved the new handle of every old handle
+ */
+template <typename Handle>
+static void renumberLines(std::vector<string> &t_lines,
+                          const std::vector<Handle> &t_moved) {
+  std::size_t count = 0;
+
+  // compaction only moves records down, so the moves never overlap
+  for (std::size_t old = 0; old < t_lines.size() && old < t_moved.size();
+       ++old) {
+    if (t_moved[old] == static_cast<Handle>(-1)) continue;
+
+    if (t_moved[old] != old) t_lines[t_moved[old]] = std::move(t_lines[old]);
+
+    count = t_moved[old] + 1;
+  }
+
+  t_lines.resize(count);
+}
+
+/**
+ * move the encoded records along with their records
+ * @param t_users the new handle of every old user handle
+ * @param t_meetings the new handle of every old meeting handle
+ */
+void CsvBackend::renumber(
+    const std::vector<Slab<User>::Handle> &t_users,
+    const std::vector<Slab<Meeting>::Handle> &t_meetings) {
+  renumberLines(this->m_userLines, t_users);
+  renumberLines(this->m_meetingLines, t_meetings);
+}
+
+/**
+ * @return the bytes of the encoded records
+ */
+std::size_t CsvBackend::footprint(void) const {
+  std::size_t bytes = 0;
+
+  for (const std::vector<string> *lines :
+       {&this->m_userLines, &this->m_meetingLines}) {
+    bytes += lines->capacity() * sizeof(string);
+
+    // a line short enough to fit in place takes no heap
+    for (const string &line : *lines)
+      if (line.capacity() >= sizeof(string) / 2) bytes += line.capacity() + 1;
+  }
+
+  return bytes;
+}
+
+/**
+ * write the changed partitions and start the journal over on them
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @param t_durable if the call waits until they are on disk
+ * @return if success, true will be returned
+ */
+bool CsvBackend::persist(const Slab<User> &t_users,
+                         const Slab<Meeting> &t_meetings, bool t_durable) {
+  const unsigned long long generation = this->m_generation;
+  const bool written = this->writeToFile(t_users, t_meetings, t_durable);
+
+  // a committed manifest makes its files the base even if some of them are
+  // still to be moved into place, so the journal follows it either way. A
+  // crash before the reset leaves a journal stamped for the old files,
+  // which the next start throws away
+  if (!written && this->m_generation == generation) return false;
+
+  if (!this->m_journal.reset(
+          baseStamp(this->m_directory, false, this->m_generation)))
+    return false;
+
+  if (!written) return false;
+
+  return !this->m_snapshot ||
+         this->writeToSnapshot(t_users, t_meetings, t_durable);
+}
+
+/**
+ * refresh the binary snapshot on every persist from now on
+ * @return true
+ */
+bool CsvBackend::keepSnapshot(void) {
+  this->m_snapshot = true;
+
+  return true;
+}
+
+/**
+ * replace the tables with the binary snapshot
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @return if success, true will be returned
+ */
+bool CsvBackend::loadSnapshot(Slab<User> &t_users, Slab<Meeting> &t_meetings) {
+  if (!this->readFromSnapshot(false, t_users, t_meetings)) return false;
+
+  this->m_dirtyUserPartitions.assign(Path::partitions, 1);
+  this->m_dirtyMeetingPartitions.assign(Path::partitions, 1);
+  this->m_userLines.clear();
+  this->m_meetingLines.clear();
+
+  return true;
+}
+
+/**
+ * read the binary snapshot
+ * @param t_current if only a snapshot of the current csv files is read
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @return if success, true will be returned
+ */
+bool CsvBackend::readFromSnapshot(bool t_current, Slab<User> &t_users,
+                                  Slab<Meeting> &t_meetings) {
+  Snapshot snapshot;
+
+  if (!snapshot.open(this->path(Path::snapshotPath).c_str())) return false;
+
+  // once there is a snapshot, checkpoints keep it up to date
+  this->m_snapshot = true;
+
+  if (t_current &&
+      snapshot.stamp() !=
+          baseStamp(this->m_directory, !this->m_importStamps.empty(),
+                    this->m_generation))
+    return false;
+
+  readSnapshot(snapshot, t_users, t_meetings);
+
+  return true;
+}
+
+/**
+ * write the binary snapshot
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @param t_durable if the call waits until it is on disk
+ * @return if success, true will be returned
+ */
+bool CsvBackend::writeToSnapshot(const Slab<User> &t_users,
+                                 const Slab<Meeting> &t_meetings,
+                                 bool t_durable) {
+  return writeSnapshot(this->path(Path::snapshotPath),
+                       baseStamp(this->m_directory,
+                                 !this->m_importStamps.empty(),
+                                 this->m_generation),
+                       t_users, t_meetings, t_durable);
+}
+
+/**
+ * build the changed partitions of a table from the encoded records, and
+ * encode the records that changed since they were last written
+ * @param t_slab the table
+ * @param t_dirty which partitions changed
+ * @param t_lines the encoded records by handle
+ * @param t_keyOf the username a record is placed by
+ * @return the content of every partition, empty for the unchanged ones
+ */
+template <typename T, typename Key>
+static std::vector<string> gatherLines(
+    const Slab<T> &t_slab, const std::vector<unsigned char> &t_dirty,
+    std::vector<string> &t_lines, Key &&t_keyOf) {
+  std::vector<std::vector<const string *>> lines(Path::partitions);
+  std::vector<std::size_t> sizes(Path::partitions, 0);
+
+  t_lines.resize(t_slab.slots());
+  t_slab.forEach([&t_slab, &t_dirty, &t_lines, &t_keyOf, &lines,
+                  &sizes](typename Slab<T>::Handle handle) {
+    const T &record = t_slab[handle];
+    int partition = CsvBackend::partitionOf(t_keyOf(record));
+
+    if (!t_dirty[partition]) return;
+
+    string &line = t_lines[handle];
+
+    if (line.empty()) {
+      Record::append(line, record);
+      line += '\n';
+    }
+
+    lines[partition].push_back(&line);
+    sizes[partition] += line.size();
+  });
+
+  // one allocation and a copy per record for each partition
+  std::vector<string> parts(Path::partitions);
+
+  for (int partition = 0; partition < Path::partitions; ++partition) {
+    parts[partition].reserve(sizes[partition]);
+
+    for (const string *line : lines[partition]) parts[partition] += *line;
+  }
+
+  return parts;
+}
+
+/**
+ * write a file whole in as few calls as it takes
+ * @param t_path the path of the file
+ * @param t_content the content
+ * @param t_durable if the call waits until it is on disk
+ * @return if success, true will be returned
+ */
+static bool writeFile(const string &t_path, const string &t_content,
+                      bool t_durable) {
+  int fd = ::open(t_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if (fd < 0) return false;
+
+  const char *data = t_content.data();
+  std::size_t left = t_content.size();
+
+  while (left > 0) {
+    ssize_t written = ::write(fd, data, left);
+
+    if (written < 0 && errno == EINTR) continue;
+
+    if (written < 0) {
+      ::close(fd);
+      return false;
+    }
+
+    data += written;
+    left -= written;
+  }
+
+  bool success = !t_durable || fsync(fd) == 0;
+
+  return ::close(fd) == 0 && success;
+}
+
+/**
+ * write the changed partitions, to temporary files first. A manifest naming
+ * them commits them together and moves the generation on, and only then
+ * are they renamed over the old ones
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @param t_durable if the call waits until they are on disk
+ * @return if success, true will be returned
+ */
+bool CsvBackend::writeToFile(const Slab<User> &t_users,
+                             const Slab<Meeting> &t_meetings, bool t_durable) {
+  const unsigned long long generation = this->m_generation + 1;
+  std::vector<string> userParts =
+      gatherLines(t_users, this->m_dirtyUserPartitions, this->m_userLines,
+                  [](const User &t_user) -> const string & {
+                    return t_user.getName();
+                  });
+  std::vector<string> meetingParts = gatherLines(
+      t_meetings, this->m_dirtyMeetingPartitions, this->m_meetingLines,
+      [](const Meeting &t_meeting) -> const string & {
+        return t_meeting.getSponsor();
+      });
+
+  // a directory made here must outlive a crash as well
+  for (const char *directory : {Path::userPath, Path::meetingPath}) {
+    const string path = this->path(directory);
+
+    if (mkdir(path.c_str(), 0755) == 0 && t_durable) syncDirectory(path);
+  }
+
+  string entries;
+
+  auto writePart = [this, generation, t_durable, &entries](
+                       const string &t_path, const string &t_records) {
+    const string temp = tempPath(t_path, generation);
+
+    if (!writeFile(temp, t_records, t_durable)) return false;
+
+    entries += "write " + manifestName(this->m_directory, t_path) + " " +
+               std::to_string(t_records.size()) + "\n";
+
+    return true;
+  };
+
+  for (int partition = 0; partition < Path::partitions; ++partition) {
+    if (this->m_dirtyUserPartitions[partition] &&
+        !writePart(partitionPath(this->path(Path::userPath), partition),
+                   userParts[partition]))
+      return false;
+
+    if (this->m_dirtyMeetingPartitions[partition] &&
+        !writePart(partitionPath(this->path(Path::meetingPath), partition),
+                   meetingParts[partition]))
+      return false;
+  }
+
+  // files to import changed since they were read wait for the next start
+  const string imports[2] = {this->path(Path::userImportPath),
+                             this->path(Path::meetingImportPath)};
+
+  for (std::size_t file = 0; file < this->m_importStamps.size(); ++file) {
+    const string &stamp = this->m_importStamps[file];
+
+    if (stamp != "-" && stamp == fileStamp(imports[file]))
+      entries += "drop " + manifestName(this->m_directory, imports[file]) +
+                 " " + stamp + "\n";
+  }
+
+  if (!entries.empty()) {
+    const string manifestTemp =
+        tempPath(this->path(Path::manifestPath), generation);
+    std::ofstream manifestStream(manifestTemp);
+
+    manifestStream << generation << "\n" << entries;
+    manifestStream.close();
+
+    if (manifestStream.fail() || (t_durable && !syncFile(manifestTemp)) ||
+        std::rename(manifestTemp.c_str(),
+                    this->path(Path::manifestPath).c_str()) != 0)
+      return false;
+
+    // the manifest is the commit point. If some of its files could not be
+    // moved into place, the partitions stay dirty and the next manifest
+    // names them again
+    this->m_generation = generation;
+
+    unsigned long long committed;
+
+    if (!commitSnapshot(this->m_directory, t_durable, committed))
+      return false;
+  }
+
+  this->m_dirtyUserPartitions.assign(Path::partitions, 0);
+  this->m_dirtyMeetingPartitions.assign(Path::partitions, 0);
+  this->m_importStamps.clear();
+
+  return true;
+}
+
+/**
+ * constructor, the tables are read by load
+ * @param t_directory the data directory, the default one if empty
+ */
+BinaryBackend::BinaryBackend(const string &t_directory)
+    : JournalBackend(t_directory), m_generation(0) {}
+
+/**
+ * load the binary tables, a missing file holds no records
+ * @param t_users the user table, empty
+ * @param t_meetings the meeting table, empty
+ */
+void BinaryBackend::load(Slab<User> &t_users, Slab<Meeting> &t_meetings) {
+  Snapshot snapshot;
+
+  if (!snapshot.open(this->path(Path::binaryPath).c_str())) return;
+
+  // the tables are stamped with their generation, 0 before there was one
+  if (!generationOf(snapshot.stamp(), this->m_generation))
+    this->m_generation = 0;
+
+  readSnapshot(snapshot, t_users, t_meetings);
+}
+
+/**
+ * replay the journal of the binary tables
+ * @param t_replay called with every record and its line number
+ */
+void BinaryBackend::replay(const Replayer &t_replay) {
+  const unsigned long long generation = this->m_generation;
+
+  this->m_journal.open(this->path(Path::binaryJournalPath).c_str(),
+                       generationStamp(generation), t_replay,
+                       [generation](std::string_view t_stamp) {
+                         return olderStamp(t_stamp, generation);
+                       });
+}
+
+/**
+ * write the binary tables whole as the next generation and start the
+ * journal over on them
+ * @param t_users the user table
+ * @param t_meetings the meeting table
+ * @param t_durable if the call waits until they are on disk
+ * @return if success, true will be returned
+ */
+bool BinaryBackend::persist(const Slab<User> &t_users,
+                            const Slab<Meeting> &t_meetings, bool t_durable) {
+  const string stamp = generationStamp(this->m_generation + 1);
+
+  if (!writeSnapshot(this->path(Path::binaryPath), stamp, t_users, t_meetings,
+                     t_durable))
+    return false;
+
+  if (t_durable) syncDirectory(this->path(Path::binaryPath));
+
+  ++this->m_generation;
+
+  // a crash before the reset leaves a journal stamped for the old
+  // generation, which the next start throws away
+  this->m_journal.reset(stamp);
+
+  return true;
+}
@@ -0,0 +1,104 @@
+#include "BloomFilter.hpp"
+#include <cmath>
+#include <functional>
+
+namespace {
+
+// 10 bits and 7 probes per string answer maybe to about 1% of absent ones
+const std::size_t bitsPerKey = 10;
+const int probes = 7;
+
+/**
+ * hash a string twice, every probe is a mix of both
+ * @param t_key the string
+ * @param t_first the first hash
+ * @param t_second the second hash, odd so the probes never repeat
+ */
+void hashOf(std::string_view t_key, std::uint64_t &t_first,
+            std::uint64_t &t_second) {
+  std::uint64_t hash = std::hash<std::string_view>()(t_key);
+
+  t_first = hash;
+  // splitmix64 finalizer, spreads the bits of the first hash
+  hash ^= hash >> 30;
+  hash *= 0xbf58476d1ce4e5b9ull;
+  hash ^= hash >> 27;
+  hash *= 0x94d049bb133111ebull;
+  hash ^= hash >> 31;
+  t_second = hash | 1;
+}
+
+}  // namespace
+
+/**
+ * default constructor, holds no bits
+ */
+BloomFilter::BloomFilter() : m_mask(0), m_keys(0), m_capacity(0) {}
+
+/**
+ * drop every string and size the filter for a number of them
+ * @param t_capacity the number of strings the filter is sized for
+ */
+void BloomFilter::reset(std::size_t t_capacity) {
+  std::uint64_t bits = 64;
+
+  while (bits < t_capacity * bitsPerKey) bits <<= 1;
+
+  this->m_words.assign(bits / 64, 0);
+  this->m_words.shrink_to_fit();
+  this->m_mask = bits - 1;
+  this->m_keys = 0;
+  this->m_capacity = t_capacity;
+}
+
+/**
+ * add a string
+ * @param t_key the string
+ */
+void BloomFilter::insert(std::string_view t_key) {
+  if (this->m_words.empty()) return;
+
+  std::uint64_t first, second;
+
+  hashOf(t_key, first, second);
+
+  for (int probe = 0; probe < probes; ++probe) {
+    const std::uint64_t bit = (first + probe * second) & this->m_mask;
+
+    this->m_words[bit >> 6] |= std::uint64_t(1) << (bit & 63);
+  }
+
+  ++this->m_keys;
+}
+
+/**
+ * @param t_key a string
+ * @return if the string may have been added, true will be returned
+ */
+bool BloomFilter::mightContain(std::string_view t_key) const {
+  if (this->m_words.empty()) return true;
+
+  std::uint64_t first, second;
+
+  hashOf(t_key, first, second);
+
+  for (int probe = 0; probe < probes; ++probe) {
+    const std::uint64_t bit = (first + probe * second) & this->m_mask;
+
+    if ((this->m_words[bit >> 6] & (std::uint64_t(1) << (bit & 63))) == 0)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * @return the chance an absent string is answered maybe
+ */
+double BloomFilter::expectedRate(void) const {
+  if (this->m_words.empty()) return 1;
+
+  const double bits = static_cast<double>(this->m_mask) + 1;
+
+  return std::pow(1 - std::exp(-probes * (this->m_keys / bits)), probes);
+}
@@ -1,9 +1,7 @@
 #include "Date.hpp"
-#include <regex>
 #include <vector>
 #include "Exception.hpp"
 
-using std::stoi;
 using std::string;
 using std::to_string;
 using std::vector;
@@ -32,6 +30,18 @@ string formatString(const int t_num) {
   return result;
 }
 
+/**
+ * @brief the key dates are compared by, which orders valid dates the way
+ * their strings do without formatting them
+ * @param a date, an invalid one throws invalid_date like dateToString
+ * @return the key of the date
+ */
+long long orderOf(const Date &t_date) {
+  if (!Date::isValid(t_date)) Date::dateToString(t_date);
+
+  return Date::dateToMinutes(t_date);
+}
+
 /**
  * @brief default constructor
  */
@@ -142,17 +152,33 @@ bool Date::isValid(const Date &t_date) {
  * 0000-00-00/00:00
  * @return a date
  */
-Date Date::stringToDate(const string &t_dateString) {
-  std::regex pattern("^(\\d{4})\\-(\\d{2})\\-(\\d{2})/(\\d{2}):(\\d{2})$");
-  std::smatch result;
+Date Date::stringToDate(std::string_view t_dateString) {
+  // yyyy-mm-dd/hh:mm, every field has a fixed width
+  static const char layout[] = "dddd-dd-dd/dd:dd";
+  const size_t length = sizeof(layout) - 1;
+  int fields[5] = {0, 0, 0, 0, 0};
+  int field = 0;
+
+  if (t_dateString.size() != length)
+    throw wrong_format("Date: " + string(t_dateString));
+
+  for (size_t i = 0; i < length; ++i) {
+    char c = t_dateString[i];
+
+    if (layout[i] != 'd') {
+      if (c != layout[i]) throw wrong_format("Date: " + string(t_dateString));
 
-  if (!std::regex_match(t_dateString, result, pattern))
-    throw wrong_format("Date: " + t_dateString);
+      ++field;
+    } else if (c >= '0' && c <= '9') {
+      fields[field] = fields[field] * 10 + (c - '0');
+    } else {
+      throw wrong_format("Date: " + string(t_dateString));
+    }
+  }
 
-  Date ret(stoi(result[1]), stoi(result[2]), stoi(result[3]), stoi(result[4]),
-           stoi(result[5]));
+  Date ret(fields[0], fields[1], fields[2], fields[3], fields[4]);
 
-  if (!isValid(ret)) throw invalid_date(t_dateString);
+  if (!isValid(ret)) throw invalid_date(string(t_dateString));
 
   return ret;
 }
@@ -172,6 +198,47 @@ string Date::dateToString(const Date &t_date) {
   return result;
 }
 
+/**
+ * @brief convert a date to the number of minutes since 0000-03-01/00:00,
+ * later dates always get larger numbers
+ * @return the minutes of the date
+ */
+long long Date::dateToMinutes(const Date &t_date) {
+  // count the years from march, so the leap day is the last day of a year
+  long long year = t_date.m_year - (t_date.m_month <= 2 ? 1 : 0);
+  long long month = t_date.m_month + (t_date.m_month <= 2 ? 9 : -3);
+  long long days = year * 365 + year / 4 - year / 100 + year / 400 +
+                   (153 * month + 2) / 5 + t_date.m_day - 1;
+
+  return (days * 24 + t_date.m_hour) * 60 + t_date.m_minute;
+}
+
+/**
+ * @brief convert the minutes counted by dateToMinutes back to a date
+ * @return the date of the minutes
+ */
+Date Date::minutesToDate(long long t_minutes) {
+  long long days = t_minutes / (24 * 60);
+  int minutes = t_minutes % (24 * 60);
+
+  // split the days into 400 year eras, then years and days of a year, all
+  // counted from march like dateToMinutes does
+  long long era = days / 146097;
+  long long dayOfEra = days - era * 146097;
+  long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 -
+                         dayOfEra / 146096) /
+                        365;
+  long long dayOfYear =
+      dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  long long month = (5 * dayOfYear + 2) / 153;
+  int day = dayOfYear - (153 * month + 2) / 5 + 1;
+
+  month += month < 10 ? 3 : -9;
+
+  return Date(era * 400 + yearOfEra + (month <= 2 ? 1 : 0), month, day,
+              minutes / 60, minutes % 60);
+}
+
 /**
  *  @brief overload the assign operator
  */
@@ -189,14 +256,14 @@ Date &Date::operator=(const Date &t_date) {
  * @brief check whether the CurrentDate is equal to the t_date
  */
 bool Date::operator==(const Date &t_date) const {
-  return Date::dateToString(*this) == Date::dateToString(t_date);
+  return orderOf(*this) == orderOf(t_date);
 }
 
 /**
  * @brief check whether the CurrentDate is  greater than the t_date
  */
 bool Date::operator>(const Date &t_date) const {
-  return Date::dateToString(*this) > Date::dateToString(t_date);
+  return orderOf(*this) > orderOf(t_date);
 }
 
 /**
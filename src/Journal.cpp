@@ -0,0 +1,289 @@
+#include "Journal.hpp"
+#include <errno.h>
+#include <fcntl.h>   // open
+#include <unistd.h>  // write fdatasync ftruncate lseek close
+#include <charconv>  // from_chars
+#include "Exception.hpp"
+#include "MappedFile.hpp"
+
+/**
+ * write a whole buffer to a file descriptor
+ * @param t_fd the file descriptor
+ * @param t_data the buffer
+ * @return if success, true will be returned
+ */
+static bool writeAll(int t_fd, std::string_view t_data) {
+  while (!t_data.empty()) {
+    ssize_t written = ::write(t_fd, t_data.data(), t_data.size());
+
+    if (written < 0) {
+      if (errno == EINTR) continue;
+
+      return false;
+    }
+
+    t_data.remove_prefix(written);
+  }
+
+  return true;
+}
+
+/**
+ * read the record count of a "T <count>" line
+ * @param t_record the record
+ * @param t_size set to the count
+ * @return if the record is a whole group header, true will be returned
+ */
+static bool groupHeader(std::string_view t_record, std::size_t &t_size) {
+  if (t_record.substr(0, 2) != "T ") return false;
+
+  const char *first = t_record.data() + 2;
+  const char *last = t_record.data() + t_record.size();
+  std::size_t size = 0;
+  auto result = std::from_chars(first, last, size);
+
+  if (result.ec != std::errc() || result.ptr != last || first == last)
+    return false;
+
+  t_size = size;
+
+  return true;
+}
+
+/**
+ * default constructor, opens nothing
+ */
+Journal::Journal() : m_fd(-1), m_records(0) {}
+
+/**
+ * destructor, flushes and closes the file
+ */
+Journal::~Journal() { this->close(); }
+
+/**
+ * open a journal file, creating it if needed, and replay its records
+ * @param t_path the path of the file
+ * @param t_base the stamp of the base snapshot the records must belong to
+ * @param t_replay called with every complete record and its line number
+ * @param t_older tells if the stamp of another snapshot names an older one
+ * @return if success, true will be returned
+ */
+bool Journal::open(const char *t_path, const std::string &t_base,
+                   const std::function<void(std::string_view, int)> &t_replay,
+                   const std::function<bool(std::string_view)> &t_older) {
+  this->close();
+
+  const std::string header = "#" + t_base + "\n";
+  MappedFile file;
+  bool belongs = false;
+  std::size_t size = 0;
+  std::size_t kept = 0;
+
+  if (file.open(t_path)) {
+    std::string_view content = file.content();
+
+    size = content.size();
+
+    if (content.substr(0, header.size()) == header) {
+      belongs = true;
+      kept = header.size();
+      content.remove_prefix(header.size());
+
+      int lineNumber = 1;
+      std::vector<std::pair<std::string_view, int>> group;
+      std::size_t groupSize = 0;
+      std::size_t groupLines = 0;
+      std::size_t groupBytes = 0;
+
+      // a last record without its '\n' was torn by a crash and is dropped,
+      // and so is a last group missing some of its records
+      for (std::size_t end; (end = content.find('\n')) !=
+                            std::string_view::npos;) {
+        std::string_view record = content.substr(0, end);
+
+        content.remove_prefix(end + 1);
+        ++lineNumber;
+        ++groupLines;
+        groupBytes += end + 1;
+
+        // a group header that does not parse is replayed as a bad record
+        if (groupSize == 0 && groupHeader(record, groupSize)) {
+          if (groupSize > 0) continue;
+        } else {
+          group.emplace_back(record, lineNumber);
+
+          if (group.size() < groupSize) continue;
+        }
+
+        for (const auto &member : group) t_replay(member.first, member.second);
+
+        this->m_records += groupLines;
+        kept += groupBytes;
+        group.clear();
+        groupSize = 0;
+        groupLines = 0;
+        groupBytes = 0;
+      }
+    } else {
+      std::size_t end = content.find('\n');
+      std::string_view stamp = content.substr(0, end);
+
+      // only a journal older than its base files was persisted and may be
+      // dropped, the records of any other one are not thrown away
+      if (end != std::string_view::npos && end + 1 < content.size() &&
+          (stamp.substr(0, 1) != "#" || !t_older(stamp.substr(1))))
+        throw wrong_format("Journal of other base files: " +
+                           std::string(t_path));
+    }
+  }
+
+  file.close();
+
+  this->m_fd = ::open(t_path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+  if (this->m_fd < 0) {
+    this->m_records = 0;
+    return false;
+  }
+
+  if (!belongs) return this->reset(t_base);
+
+  if (kept < size && ftruncate(this->m_fd, kept) < 0) return false;
+
+  return true;
+}
+
+/**
+ * flush and close the file
+ */
+void Journal::close(void) {
+  if (this->m_fd < 0) return;
+
+  this->flush();
+  ::close(this->m_fd);
+  this->m_fd = -1;
+  this->m_records = 0;
+}
+
+/**
+ * @return if a file is open, true will be returned
+ */
+bool Journal::isOpen(void) const { return this->m_fd >= 0; }
+
+/**
+ * buffer a record, it reaches the file on the next flush
+ * @param t_record the record, without '\n'
+ */
+void Journal::append(const std::string &t_record) {
+  if (this->m_fd < 0) return;
+
+  this->m_buffer += t_record;
+  this->m_buffer += '\n';
+  ++this->m_records;
+}
+
+/**
+ * buffer a group of records that is replayed whole or not at all
+ * @param t_records the records, without '\n'
+ */
+void Journal::appendGroup(const std::vector<std::string> &t_records) {
+  if (this->m_fd < 0 || t_records.empty()) return;
+
+  this->append("T " + std::to_string(t_records.size()));
+
+  for (const std::string &record : t_records) this->append(record);
+}
+
+/**
+ * write the buffered records to the file
+ * @return if success, true will be returned
+ */
+bool Journal::flush(void) {
+  const std::string records = this->takeBuffer();
+
+  if (this->write(records, false)) return true;
+
+  this->restoreBuffer(records);
+
+  return false;
+}
+
+/**
+ * write the buffered records and wait until they are on disk
+ * @return if success, true will be returned
+ */
+bool Journal::sync(void) {
+  const std::string records = this->takeBuffer();
+
+  if (this->write(records, true)) return true;
+
+  this->restoreBuffer(records);
+
+  return false;
+}
+
+/**
+ * hand over the buffered records
+ * @return the records, each ending with '\n'
+ */
+std::string Journal::takeBuffer(void) {
+  std::string records;
+
+  records.swap(this->m_buffer);
+
+  return records;
+}
+
+/**
+ * put records taken from the buffer back in front of it
+ * @param t_records the records, each ending with '\n'
+ */
+void Journal::restoreBuffer(const std::string &t_records) {
+  this->m_buffer.insert(0, t_records);
+}
+
+/**
+ * write records taken from the buffer to the file. On failure the file is
+ * cut back to where it ended, so no part of the records stays to be
+ * followed by their retry
+ * @param t_records the records, each ending with '\n'
+ * @param t_durable if the call waits until they are on disk
+ * @return if success, true will be returned
+ */
+bool Journal::write(const std::string &t_records, bool t_durable) const {
+  if (this->m_fd < 0) return false;
+
+  const off_t end = lseek(this->m_fd, 0, SEEK_END);
+
+  if (end < 0) return false;
+
+  const bool written = writeAll(this->m_fd, t_records) &&
+                       (!t_durable || fdatasync(this->m_fd) == 0);
+
+  // a torn line would be replayed as a bad record, or miscount a group
+  if (!written && ftruncate(this->m_fd, end) < 0) return false;
+
+  return written;
+}
+
+/**
+ * drop every record and start over on a new base snapshot
+ * @param t_base the stamp of the new base snapshot
+ * @return if success, true will be returned
+ */
+bool Journal::reset(const std::string &t_base) {
+  if (this->m_fd < 0) return false;
+
+  this->m_buffer.clear();
+  this->m_records = 0;
+
+  // O_APPEND puts the header at the new end of the file
+  if (ftruncate(this->m_fd, 0) < 0) return false;
+
+  return writeAll(this->m_fd, "#" + t_base + "\n");
+}
+
+/**
+ * @return the number of records since the base snapshot
+ */
+std::size_t Journal::records(void) const { return this->m_records; }
@@ -0,0 +1,71 @@
+#include "MappedFile.hpp"
+#include <fcntl.h>     // open
+#include <sys/mman.h>  // mmap munmap
+#include <sys/stat.h>  // fstat
+#include <unistd.h>    // close
+
+/**
+ * default constructor, maps nothing
+ */
+MappedFile::MappedFile() : m_data(nullptr), m_size(0) {}
+
+/**
+ * destructor, unmaps the file
+ */
+MappedFile::~MappedFile() { this->close(); }
+
+/**
+ * map a file, replacing the current one
+ * @param t_path the path of the file
+ * @return if success, true will be returned
+ */
+bool MappedFile::open(const char *t_path) {
+  this->close();
+
+  int fd = ::open(t_path, O_RDONLY);
+
+  if (fd < 0) return false;
+
+  struct stat status;
+
+  if (fstat(fd, &status) < 0) {
+    ::close(fd);
+    return false;
+  }
+
+  // mmap refuses empty mappings, an empty file simply has no content
+  if (status.st_size > 0) {
+    void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (data == MAP_FAILED) {
+      ::close(fd);
+      return false;
+    }
+
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+    this->m_data = static_cast<const char *>(data);
+    this->m_size = status.st_size;
+  }
+
+  ::close(fd);
+
+  return true;
+}
+
+/**
+ * unmap the current file
+ */
+void MappedFile::close(void) {
+  if (this->m_data != nullptr)
+    munmap(const_cast<char *>(this->m_data), this->m_size);
+
+  this->m_data = nullptr;
+  this->m_size = 0;
+}
+
+/**
+ * @return the content of the file, empty if nothing is mapped
+ */
+std::string_view MappedFile::content(void) const {
+  return std::string_view(this->m_data, this->m_size);
+}
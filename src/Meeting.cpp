@@ -1,5 +1,6 @@
 #include "Meeting.hpp"
 #include <algorithm>
+#include <utility>  // move swap
 
 using std::find;
 using std::string;
@@ -11,29 +12,97 @@ using std::vector;
 Meeting::Meeting(const string &t_sponsor, const vector<string> &t_participators,
                  const Date &t_startTime, const Date &t_endTime,
                  const string &t_title)
-    : m_sponsor(t_sponsor),
-      m_participators(move(t_participators)),
+    : m_sponsor(Symbols::intern(t_sponsor)),
       m_startDate(t_startTime),
       m_endDate(t_endTime),
-      m_title(t_title) {}
+      m_title(t_title) {
+  this->setParticipator(t_participators);
+}
 
 /**
  * @brief copy constructor of left value
  */
-Meeting::Meeting(const Meeting &t_meeting) = default;
+Meeting::Meeting(const Meeting &t_meeting)
+    : m_sponsor(t_meeting.m_sponsor),
+      m_participators(t_meeting.m_participators),
+      m_startDate(t_meeting.m_startDate),
+      m_endDate(t_meeting.m_endDate),
+      m_title(t_meeting.m_title) {
+  Symbols::retain(this->m_sponsor);
+
+  for (Symbols::Id participator : this->m_participators)
+    Symbols::retain(participator);
+}
+
+/**
+ * @brief move constructor
+ */
+Meeting::Meeting(Meeting &&t_meeting) noexcept
+    : m_sponsor(t_meeting.m_sponsor),
+      m_participators(std::move(t_meeting.m_participators)),
+      m_startDate(t_meeting.m_startDate),
+      m_endDate(t_meeting.m_endDate),
+      m_title(std::move(t_meeting.m_title)) {
+  // the references move along with the ids
+  t_meeting.m_sponsor = Symbols::empty;
+  t_meeting.m_participators.clear();
+}
+
+/**
+ * @brief copy assignment
+ */
+Meeting &Meeting::operator=(const Meeting &t_meeting) {
+  if (this != &t_meeting) *this = Meeting(t_meeting);
+
+  return *this;
+}
+
+/**
+ * @brief move assignment
+ */
+Meeting &Meeting::operator=(Meeting &&t_meeting) noexcept {
+  std::swap(this->m_sponsor, t_meeting.m_sponsor);
+  this->m_participators.swap(t_meeting.m_participators);
+  this->m_startDate = t_meeting.m_startDate;
+  this->m_endDate = t_meeting.m_endDate;
+  this->m_title = std::move(t_meeting.m_title);
+
+  return *this;
+}
+
+/**
+ * @brief destructor, releases the ids
+ */
+Meeting::~Meeting() {
+  Symbols::release(this->m_sponsor);
+
+  for (Symbols::Id participator : this->m_participators)
+    Symbols::release(participator);
+}
 
 /**
  *   @brief get the meeting's sponsor
  *   @return a string indicate sponsor
  */
-string Meeting::getSponsor(void) const { return this->m_sponsor; }
+const string &Meeting::getSponsor(void) const {
+  return Symbols::name(this->m_sponsor);
+}
+
+/**
+ *   @brief get the id of the meeting's sponsor
+ *   @return the id in the symbol table
+ */
+Symbols::Id Meeting::getSponsorId(void) const { return this->m_sponsor; }
 
 /**
  * @brief set the sponsor of a meeting
  * @param  the new sponsor string
  */
 void Meeting::setSponsor(const string &t_sponsor) {
-  this->m_sponsor = t_sponsor;
+  const Symbols::Id sponsor = Symbols::intern(t_sponsor);
+
+  Symbols::release(this->m_sponsor);
+  this->m_sponsor = sponsor;
 }
 
 /**
@@ -41,6 +110,21 @@ void Meeting::setSponsor(const string &t_sponsor) {
  * @return return a string vector indicate participators
  */
 vector<string> Meeting::getParticipator(void) const {
+  vector<string> participators;
+
+  participators.reserve(this->m_participators.size());
+
+  for (Symbols::Id participator : this->m_participators)
+    participators.push_back(Symbols::name(participator));
+
+  return participators;
+}
+
+/**
+ * @brief  get the ids of the participators of a meeting
+ * @return the ids in the symbol table
+ */
+const vector<Symbols::Id> &Meeting::getParticipatorIds(void) const {
   return this->m_participators;
 }
 
@@ -49,7 +133,17 @@ vector<string> Meeting::getParticipator(void) const {
  *   @param the new participators vector
  */
 void Meeting::setParticipator(const vector<string> &t_participators) {
-  this->m_participators = t_participators;
+  vector<Symbols::Id> participators;
+
+  participators.reserve(t_participators.size());
+
+  for (const string &participator : t_participators)
+    participators.push_back(Symbols::intern(participator));
+
+  this->m_participators.swap(participators);
+
+  for (Symbols::Id participator : participators)
+    Symbols::release(participator);
 }
 
 /**
@@ -57,7 +151,7 @@ void Meeting::setParticipator(const vector<string> &t_participators) {
  * @param the new participator
  */
 void Meeting::addParticipator(const std::string &t_participator) {
-  this->m_participators.push_back(t_participator);
+  this->m_participators.push_back(Symbols::intern(t_participator));
 }
 
 /**
@@ -65,18 +159,28 @@ void Meeting::addParticipator(const std::string &t_participator) {
  * @param the participator to be removed
  */
 void Meeting::removeParticipator(const std::string &t_participator) {
-  vector<string>::iterator it =
-      find(this->m_participators.begin(), this->m_participators.end(),
-           t_participator);
+  // the names of held ids are read without the lock of the table
+  vector<Symbols::Id>::iterator it = std::find_if(
+      this->m_participators.begin(), this->m_participators.end(),
+      [&t_participator](Symbols::Id t_id) {
+        return Symbols::name(t_id) == t_participator;
+      });
+
+  if (it == this->m_participators.end()) return;
+
+  const Symbols::Id participator = *it;
 
-  if (it != this->m_participators.end()) this->m_participators.erase(it);
+  this->m_participators.erase(it);
+  Symbols::release(participator);
 }
 
 /**
  * @brief get the startDate of a meeting
  * @return return a string indicate startDate
  */
-Date Meeting::getStartDate(void) const { return this->m_startDate; }
+const Date &Meeting::getStartDate(void) const {
+  return this->m_startDate;
+}
 
 /**
  * @brief  set the startDate of a meeting
@@ -90,7 +194,7 @@ void Meeting::setStartDate(const Date &t_startTime) {
  * @brief get the endDate of a meeting
  * @return a date indicate the endDate
  */
-Date Meeting::getEndDate(void) const { return this->m_endDate; }
+const Date &Meeting::getEndDate(void) const { return this->m_endDate; }
 
 /**
  * @brief  set the endDate of a meeting
@@ -102,7 +206,7 @@ void Meeting::setEndDate(const Date &t_endTime) { this->m_endDate = t_endTime; }
  * @brief get the title of a meeting
  * @return a date title the endDate
  */
-string Meeting::getTitle(void) const { return this->m_title; }
+const string &Meeting::getTitle(void) const { return this->m_title; }
 
 /**
  * @brief  set the title of a meeting
@@ -116,6 +220,18 @@ void Meeting::setTitle(const string &t_title) { this->m_title = t_title; }
  * @return if the user take part in this meeting
  */
 bool Meeting::isParticipator(const string &t_username) const {
+  for (Symbols::Id participator : this->m_participators)
+    if (Symbols::name(participator) == t_username) return true;
+
+  return false;
+}
+
+/**
+ * @brief check if the user take part in this meeting
+ * @param t_user the id of the user
+ * @return if the user take part in this meeting
+ */
+bool Meeting::isParticipator(Symbols::Id t_user) const {
   return find(this->m_participators.begin(), this->m_participators.end(),
-              t_username) != this->m_participators.end();
+              t_user) != this->m_participators.end();
 }
\ No newline at end of file
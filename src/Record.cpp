@@ -0,0 +1,252 @@
+#include "Record.hpp"
+#include <vector>
+#include "Exception.hpp"
+
+using std::string;
+
+/**
+ * take the next line out of a file content
+ * @param t_content the rest of the content, the line is removed from it
+ * @param t_line the line without its '\n'
+ * @return if there was a line left, true will be returned
+ */
+bool Record::nextLine(std::string_view &t_content,
+                      std::string_view &t_line) {
+  if (t_content.empty()) return false;
+
+  size_t end = t_content.find('\n');
+
+  if (end == std::string_view::npos) {
+    t_line = t_content;
+    t_content = std::string_view();
+  } else {
+    t_line = t_content.substr(0, end);
+    t_content.remove_prefix(end + 1);
+  }
+
+  return true;
+}
+
+/**
+ * split a CSV line of quoted, non-empty fields: "<f1>","<f2>",...
+ * the separators are taken from the right, as the greedy regular expression
+ * the loader used to match did
+ * @param t_line the source line
+ * @param t_fields the fields found
+ * @param t_count the number of fields expected
+ * @param t_allowEmpty if empty fields are accepted
+ * @return if the line has the expected format, true will be returned
+ */
+bool Record::split(std::string_view t_line, std::string_view *t_fields,
+                   size_t t_count, bool t_allowEmpty) {
+  const std::string_view separator = "\",\"";
+
+  if (t_line.size() < 2 || t_line.front() != '"' || t_line.back() != '"' ||
+      t_line.find('\r') != std::string_view::npos)
+    return false;
+
+  std::string_view rest = t_line.substr(1, t_line.size() - 2);
+
+  for (size_t field = t_count - 1; field > 0; --field) {
+    size_t pos = rest.rfind(separator);
+
+    if (pos == std::string_view::npos) return false;
+
+    t_fields[field] = rest.substr(pos + separator.size());
+    rest = rest.substr(0, pos);
+  }
+
+  t_fields[0] = rest;
+
+  if (t_allowEmpty) return true;
+
+  for (size_t field = 0; field < t_count; ++field) {
+    if (t_fields[field].empty()) return false;
+  }
+
+  return true;
+}
+
+/**
+ * build a user from the fields of a record
+ * @param t_fields <username>,<password>,<email>,<phone>
+ * @return the user
+ */
+User Record::parseUser(const std::string_view *t_fields) {
+  return User(string(t_fields[0]), string(t_fields[1]), string(t_fields[2]),
+              string(t_fields[3]));
+}
+
+/**
+ * build a meeting from the fields of a record
+ * @param t_fields <sponsor>,<participators>,<start date>,<end date>,<title>
+ * @param t_at the position of the record, appended to error messages
+ * @return the meeting
+ */
+Meeting Record::parseMeeting(const std::string_view *t_fields,
+                             const string &t_at) {
+  std::vector<string> participators;
+  std::string_view rest = t_fields[1];
+
+  // split the participators on '&'
+  for (size_t pos; (pos = rest.find('&')) != std::string_view::npos;) {
+    participators.emplace_back(rest.substr(0, pos));
+    rest.remove_prefix(pos + 1);
+  }
+
+  // the journal may log a meeting whose last participator just left
+  if (!rest.empty() || !participators.empty())
+    participators.emplace_back(rest);
+
+  Date startDate, endDate;
+
+  try {
+    startDate = Date::stringToDate(t_fields[2]);
+    endDate = Date::stringToDate(t_fields[3]);
+  } catch (const wrong_format &e) {
+    throw wrong_format(e.what() + t_at);
+  } catch (const invalid_date &e) {
+    throw invalid_date(e.what() + t_at);
+  }
+
+  return Meeting(string(t_fields[0]), participators, startDate, endDate,
+                 string(t_fields[4]));
+}
+
+/**
+ * read a user record
+ * @param t_line <username>,<password>,<email>,<phone>
+ * @param t_at the position of the record, appended to error messages
+ * @return the user
+ */
+User Record::readUser(std::string_view t_line, const string &t_at) {
+  std::string_view fields[4];
+
+  if (!split(t_line, fields, 4))
+    throw wrong_format("Wrong User CSV Format" + t_at);
+
+  return parseUser(fields);
+}
+
+/**
+ * read a meeting record
+ * @param t_line <sponsor>,<participators>,<start date>,<end date>,<title>
+ * @param t_at the position of the record, appended to error messages
+ * @return the meeting
+ */
+Meeting Record::readMeeting(std::string_view t_line, const string &t_at) {
+  std::string_view fields[5];
+
+  if (!split(t_line, fields, 5))
+    throw wrong_format("Wrong Meeting CSV Format" + t_at);
+
+  return parseMeeting(fields, t_at);
+}
+
+/**
+ * append a date as yyyy-mm-dd/hh:mm, formatted in place
+ * @param t_out the buffer
+ * @param t_date the date, an invalid one throws invalid_date
+ */
+static void appendDate(string &t_out, const Date &t_date) {
+  // dateToString builds the message of the same exception
+  if (!Date::isValid(t_date)) Date::dateToString(t_date);
+
+  const int year = t_date.getYear();
+  char text[16] = {char('0' + year / 1000),
+                   char('0' + year / 100 % 10),
+                   char('0' + year / 10 % 10),
+                   char('0' + year % 10),
+                   '-',
+                   char('0' + t_date.getMonth() / 10),
+                   char('0' + t_date.getMonth() % 10),
+                   '-',
+                   char('0' + t_date.getDay() / 10),
+                   char('0' + t_date.getDay() % 10),
+                   '/',
+                   char('0' + t_date.getHour() / 10),
+                   char('0' + t_date.getHour() % 10),
+                   ':',
+                   char('0' + t_date.getMinute() / 10),
+                   char('0' + t_date.getMinute() % 10)};
+
+  t_out.append(text, sizeof(text));
+}
+
+/**
+ * append a user as a record of the user file
+ * @param t_out the buffer
+ * @param t_user the source user
+ */
+void Record::append(string &t_out, const User &t_user) {
+  t_out += '"';
+  t_out += t_user.getName();
+  t_out += "\",\"";
+  t_out += t_user.getPassword();
+  t_out += "\",\"";
+  t_out += t_user.getEmail();
+  t_out += "\",\"";
+  t_out += t_user.getPhone();
+  t_out += '"';
+}
+
+/**
+ * append a meeting as a record of the meeting file
+ * @param t_out the buffer
+ * @param t_meeting the source meeting
+ */
+void Record::append(string &t_out, const Meeting &t_meeting) {
+  t_out += '"';
+  t_out += t_meeting.getSponsor();
+  t_out += "\",\"";
+
+  bool first = true;
+
+  for (Symbols::Id participator : t_meeting.getParticipatorIds()) {
+    if (!first) t_out += '&';
+
+    t_out += Symbols::name(participator);
+    first = false;
+  }
+
+  t_out += "\",\"";
+  appendDate(t_out, t_meeting.getStartDate());
+  t_out += "\",\"";
+  appendDate(t_out, t_meeting.getEndDate());
+  t_out += "\",\"";
+  t_out += t_meeting.getTitle();
+  t_out += '"';
+}
+
+/**
+ * encode a user as a record of the user file
+ * @param t_user the source user
+ * @return the record, without '\n'
+ */
+string Record::encode(const User &t_user) {
+  string record;
+
+  append(record, t_user);
+
+  return record;
+}
+
+/**
+ * encode a meeting as a record of the meeting file
+ * @param t_meeting the source meeting
+ * @return the record, without '\n'
+ */
+string Record::encode(const Meeting &t_meeting) {
+  string record;
+
+  append(record, t_meeting);
+
+  return record;
+}
+
+/**
+ * encode the key of a journal record
+ * @param t_key the username or title
+ * @return the quoted key
+ */
+string Record::quote(const string &t_key) { return "\"" + t_key + "\""; }
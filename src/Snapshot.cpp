@@ -0,0 +1,259 @@
+#include "Snapshot.hpp"
+#include <fcntl.h>   // open
+#include <unistd.h>  // fsync close
+#include <cstdio>    // rename
+#include <cstring>   // memcmp memcpy
+#include <fstream>   // ofstream
+
+using snapshot::Header;
+using snapshot::MeetingRecord;
+using snapshot::StringRef;
+using snapshot::UserRecord;
+
+/**
+ * put a string into the string table once
+ * @param t_string the string
+ * @return where the string is in the table
+ */
+StringRef SnapshotWriter::intern(const std::string &t_string) {
+  auto entry = this->m_interned.find(t_string);
+
+  if (entry != this->m_interned.end()) return entry->second;
+
+  StringRef ref = {static_cast<std::uint32_t>(this->m_strings.size()),
+                   static_cast<std::uint32_t>(t_string.size())};
+
+  this->m_strings += t_string;
+  this->m_interned.emplace(t_string, ref);
+
+  return ref;
+}
+
+/**
+ * add a user to the snapshot
+ * @param t_user the user
+ */
+void SnapshotWriter::addUser(const User &t_user) {
+  this->m_users.push_back({this->intern(t_user.getName()),
+                           this->intern(t_user.getPassword()),
+                           this->intern(t_user.getEmail()),
+                           this->intern(t_user.getPhone())});
+}
+
+/**
+ * add a meeting to the snapshot
+ * @param t_meeting the meeting
+ */
+void SnapshotWriter::addMeeting(const Meeting &t_meeting) {
+  MeetingRecord record;
+
+  record.start = Date::dateToMinutes(t_meeting.getStartDate());
+  record.end = Date::dateToMinutes(t_meeting.getEndDate());
+  record.sponsor = this->intern(t_meeting.getSponsor());
+  record.title = this->intern(t_meeting.getTitle());
+  record.firstParticipator = this->m_participators.size();
+  record.participatorCount = t_meeting.getParticipatorIds().size();
+
+  for (Symbols::Id participator : t_meeting.getParticipatorIds())
+    this->m_participators.push_back(this->intern(Symbols::name(participator)));
+
+  this->m_meetings.push_back(record);
+}
+
+/**
+ * write the snapshot through a temporary file renamed into place
+ * @param t_path the path of the snapshot
+ * @param t_stamp the stamp of the csv files the snapshot is taken from
+ * @param t_durable if the snapshot must reach the disk
+ * @return if success, true will be returned
+ */
+bool SnapshotWriter::write(const char *t_path, const std::string &t_stamp,
+                           bool t_durable) {
+  Header header;
+
+  std::memcpy(header.magic, snapshot::magic, sizeof(header.magic));
+  header.version = snapshot::version;
+  header.userCount = this->m_users.size();
+  header.meetingCount = this->m_meetings.size();
+  header.participatorCount = this->m_participators.size();
+  header.stamp = this->intern(t_stamp);
+  header.stringBytes = this->m_strings.size();
+
+  const std::string temp = std::string(t_path) + ".tmp";
+  std::ofstream stream(temp, std::ofstream::binary);
+
+  stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char *>(this->m_users.data()),
+               this->m_users.size() * sizeof(UserRecord));
+  stream.write(reinterpret_cast<const char *>(this->m_meetings.data()),
+               this->m_meetings.size() * sizeof(MeetingRecord));
+  stream.write(reinterpret_cast<const char *>(this->m_participators.data()),
+               this->m_participators.size() * sizeof(StringRef));
+  stream.write(this->m_strings.data(), this->m_strings.size());
+  stream.close();
+
+  if (stream.fail()) return false;
+
+  if (t_durable) {
+    int fd = ::open(temp.c_str(), O_RDONLY);
+
+    if (fd < 0 || fsync(fd) != 0) {
+      if (fd >= 0) ::close(fd);
+      return false;
+    }
+
+    ::close(fd);
+  }
+
+  return std::rename(temp.c_str(), t_path) == 0;
+}
+
+/**
+ * default constructor, maps nothing
+ */
+Snapshot::Snapshot()
+    : m_header(nullptr),
+      m_users(nullptr),
+      m_meetings(nullptr),
+      m_participators(nullptr),
+      m_strings(nullptr) {}
+
+/**
+ * map a snapshot and check its header and records
+ * @param t_path the path of the snapshot
+ * @return if the snapshot exists and is well formed, true will be returned
+ */
+bool Snapshot::open(const char *t_path) {
+  this->m_header = nullptr;
+
+  if (!this->m_file.open(t_path)) return false;
+
+  std::string_view content = this->m_file.content();
+
+  if (content.size() < sizeof(Header)) return false;
+
+  const Header *header = reinterpret_cast<const Header *>(content.data());
+
+  if (std::memcmp(header->magic, snapshot::magic, sizeof(header->magic)) != 0 ||
+      header->version != snapshot::version)
+    return false;
+
+  std::uint64_t userBytes =
+      std::uint64_t(header->userCount) * sizeof(UserRecord);
+  std::uint64_t meetingBytes =
+      std::uint64_t(header->meetingCount) * sizeof(MeetingRecord);
+  std::uint64_t participatorBytes =
+      std::uint64_t(header->participatorCount) * sizeof(StringRef);
+
+  if (sizeof(Header) + userBytes + meetingBytes + participatorBytes +
+          header->stringBytes !=
+      content.size())
+    return false;
+
+  const char *data = content.data() + sizeof(Header);
+
+  this->m_users = reinterpret_cast<const UserRecord *>(data);
+  this->m_meetings =
+      reinterpret_cast<const MeetingRecord *>(data + userBytes);
+  this->m_participators = reinterpret_cast<const StringRef *>(
+      data + userBytes + meetingBytes);
+  this->m_strings = data + userBytes + meetingBytes + participatorBytes;
+
+  // check every reference once, so reads never leave the mapping
+  auto inTable = [header](StringRef t_ref) {
+    return std::uint64_t(t_ref.offset) + t_ref.length <= header->stringBytes;
+  };
+  auto validMinutes = [](std::int64_t t_minutes) {
+    return t_minutes >= 0 && Date::isValid(Date::minutesToDate(t_minutes));
+  };
+
+  if (!inTable(header->stamp)) return false;
+
+  for (std::uint32_t i = 0; i < header->userCount; ++i) {
+    const UserRecord &user = this->m_users[i];
+
+    if (!inTable(user.name) || !inTable(user.password) ||
+        !inTable(user.email) || !inTable(user.phone))
+      return false;
+  }
+
+  for (std::uint32_t i = 0; i < header->participatorCount; ++i) {
+    if (!inTable(this->m_participators[i])) return false;
+  }
+
+  for (std::uint32_t i = 0; i < header->meetingCount; ++i) {
+    const MeetingRecord &meeting = this->m_meetings[i];
+
+    if (!inTable(meeting.sponsor) || !inTable(meeting.title) ||
+        std::uint64_t(meeting.firstParticipator) + meeting.participatorCount >
+            header->participatorCount ||
+        !validMinutes(meeting.start) || !validMinutes(meeting.end))
+      return false;
+  }
+
+  this->m_header = header;
+
+  return true;
+}
+
+/**
+ * @return the stamp of the csv files the snapshot was taken from
+ */
+std::string_view Snapshot::stamp(void) const {
+  return this->string(this->m_header->stamp);
+}
+
+/**
+ * @return the number of users
+ */
+std::uint32_t Snapshot::userCount(void) const {
+  return this->m_header->userCount;
+}
+
+/**
+ * @return the number of meetings
+ */
+std::uint32_t Snapshot::meetingCount(void) const {
+  return this->m_header->meetingCount;
+}
+
+/**
+ * @param t_index the index of the user
+ * @return the user
+ */
+User Snapshot::user(std::uint32_t t_index) const {
+  const UserRecord &user = this->m_users[t_index];
+
+  return User(std::string(this->string(user.name)),
+              std::string(this->string(user.password)),
+              std::string(this->string(user.email)),
+              std::string(this->string(user.phone)));
+}
+
+/**
+ * @param t_index the index of the meeting
+ * @return the meeting
+ */
+Meeting Snapshot::meeting(std::uint32_t t_index) const {
+  const MeetingRecord &meeting = this->m_meetings[t_index];
+  std::vector<std::string> participators;
+
+  participators.reserve(meeting.participatorCount);
+
+  for (std::uint32_t i = 0; i < meeting.participatorCount; ++i)
+    participators.emplace_back(
+        this->string(this->m_participators[meeting.firstParticipator + i]));
+
+  return Meeting(std::string(this->string(meeting.sponsor)), participators,
+                 Date::minutesToDate(meeting.start),
+                 Date::minutesToDate(meeting.end),
+                 std::string(this->string(meeting.title)));
+}
+
+/**
+ * @param t_ref where the string is in the string table
+ * @return the string
+ */
+std::string_view Snapshot::string(StringRef t_ref) const {
+  return std::string_view(this->m_strings + t_ref.offset, t_ref.length);
+}
@@ -1,163 +1,524 @@
 #include "Storage.hpp"
-#include <fstream>  // ifstream ostream
-#include <regex>    // reges expression
+#include <algorithm>  // count find sort
+#include <cstring>    // strlen
+#include <limits>     // numeric_limits
+#include <string_view>
 #include "Exception.hpp"
+#include "Record.hpp"
 
 using std::function;
 using std::list;
 using std::string;
 
+// the std::function overloads forward to the templates in Storage.hpp
+typedef function<bool(const User &)> UserFilter;
+typedef function<void(User &)> UserSwitcher;
+typedef function<void(const User &)> UserVisitor;
+typedef function<bool(const Meeting &)> MeetingFilter;
+typedef function<void(Meeting &)> MeetingSwitcher;
+typedef function<void(const Meeting &)> MeetingVisitor;
+
 std::shared_ptr<Storage> Storage::m_instance = nullptr;
+std::mutex Storage::m_instanceMutex;
+function<std::unique_ptr<Backend>(void)> Storage::m_backendFactory = []() {
+  return Backend::create("csv");
+};
+
+const char *Path::dataPath = "data";
+const char *Path::userPath = "data/users";
+const char *Path::meetingPath = "data/meetings";
+const int Path::partitions = 8;
+const char *Path::userImportPath = "data/users.csv";
+const char *Path::meetingImportPath = "data/meetings.csv";
+const char *Path::journalPath = "data/journal.log";
+const char *Path::manifestPath = "data/manifest";
+const char *Path::snapshotPath = "data/agenda.snap";
+const char *Path::binaryPath = "data/agenda.bin";
+const char *Path::binaryJournalPath = "data/agenda.bin.log";
+
+// the fewest users the username filter is sized for
+static const std::size_t userFilterMinimum = 1024;
+
+/**
+ * move a path from the default data directory to another one
+ * @param t_directory the data directory, the default one if empty
+ * @param t_path a path in the default data directory
+ * @return the path in the data directory
+ */
+string Path::in(const string &t_directory, const char *t_path) {
+  if (t_directory.empty()) return t_path;
 
-const char *Path::userPath = "data/users.csv";
-const char *Path::meetingPath = "data/meetings.csv";
+  return t_directory + (t_path + std::strlen(Path::dataPath));
+}
 
 /**
- *  default constructor
+ * @param t_string a string
+ * @return the bytes it holds on the heap, none while it fits in place
  */
-Storage::Storage() : m_dirty(false) { this->readFromFile(); }
+static std::size_t payloadOf(const string &t_string) {
+  return t_string.capacity() < sizeof(string) / 2 ? 0
+                                                  : t_string.capacity() + 1;
+}
 
 /**
- * read file content into memory
- * @return if success, true will be returned
+ *  constructor
+ *  @param t_backend where the tables are kept between runs
+ */
+Storage::Storage(std::unique_ptr<Backend> t_backend)
+    : m_concurrent(false),
+      m_inTransaction(false),
+      m_flushInterval(0),
+      m_flushThreshold(std::numeric_limits<std::size_t>::max()),
+      m_flusherStopping(false),
+      m_flushRequested(0),
+      m_flushCompleted(0),
+      m_flushSucceeded(true),
+      m_unflushed(0),
+      m_versionStale(true),
+      m_filterLookups(0),
+      m_filterRejections(0),
+      m_filterFalsePositives(0),
+      m_backend(std::move(t_backend)),
+      m_fsyncPolicy(batched),
+      m_fsyncBatch(32),
+      m_unsyncedSyncs(0),
+      m_dirty(false) {
+  this->m_backend->load(this->m_users, this->m_meetings);
+  this->rebuildIndexes();
+  this->m_backend->replay([this](std::string_view t_record, int t_line) {
+    this->replay(t_record, t_line);
+  });
+}
+
+/**
+ * collect the sponsor and participators of a meeting without repeats
+ * @param t_meeting the source meeting
+ * @return the ids of the users related to the meeting
  */
-bool Storage::readFromFile(void) {
-  std::ifstream userStream(Path::userPath);
+static std::vector<Symbols::Id> meetingUsers(const Meeting &t_meeting) {
+  std::vector<Symbols::Id> users = t_meeting.getParticipatorIds();
+
+  users.push_back(t_meeting.getSponsorId());
+
+  for (auto it = users.begin(); it != users.end();) {
+    if (std::find(users.begin(), it, *it) != it) {
+      it = users.erase(it);
+    } else {
+      ++it;
+    }
+  }
 
-  if (userStream.fail()) return false;
+  return users;
+}
+
+/**
+ * add a meeting to the posting list and schedule of one user
+ * @param t_user the sponsor or participator
+ * @param t_meeting the handle of the meeting
+ */
+void Storage::indexMeetingUser(Symbols::Id t_user, MeetingHandle t_meeting) {
+  this->m_meetingIndex[t_user].push_back(t_meeting);
+  const Meeting &meeting = this->m_meetings[t_meeting];
 
-  std::ifstream meetingStream(Path::meetingPath);
+  this->m_scheduleIndex[t_user].insert(
+      Date::dateToMinutes(meeting.getStartDate()),
+      Date::dateToMinutes(meeting.getEndDate()), t_meeting);
+}
 
-  if (meetingStream.fail()) return false;
+/**
+ * remove a meeting from the posting list and schedule of one user
+ * @param t_user the sponsor or participator
+ * @param t_meeting the handle of the meeting
+ * @param t_start the start minute the meeting was scheduled with
+ */
+void Storage::unindexMeetingUser(Symbols::Id t_user,
+                                 MeetingHandle t_meeting,
+                                 long long t_start) {
+  auto entry = this->m_meetingIndex.find(t_user);
 
-  std::smatch result;
+  if (entry == this->m_meetingIndex.end()) return;
 
-  // <username>,<password>,<email>,<phone>
-  std::regex userCSVPattern("^\"(.+)\",\"(.+)\",\"(.+)\",\"(.+)\"$");
+  std::vector<MeetingHandle> &postings = entry->second;
+  auto posting = std::find(postings.begin(), postings.end(), t_meeting);
 
-  for (string line; std::getline(userStream, line);) {
-    if (!std::regex_match(line, result, userCSVPattern))
-      throw wrong_format("Wrong User CSV Format");
+  if (posting != postings.end()) postings.erase(posting);
 
-    this->m_userList.push_back(
-        User(result[1], result[2], result[3], result[4]));
+  // a user left with no meetings gives the memory back
+  if (postings.empty()) {
+    this->m_meetingIndex.erase(entry);
+    this->m_scheduleIndex.erase(t_user);
+  } else {
+    this->m_scheduleIndex[t_user].erase(t_start, t_meeting);
   }
+}
 
-  userStream.close();
+/**
+ * add a meeting to the indexes of its sponsor and participators
+ * @param t_meeting the handle of the meeting
+ */
+void Storage::indexMeeting(MeetingHandle t_meeting) {
+  const Meeting &meeting = this->m_meetings[t_meeting];
 
-  // <sponsor>,<participators>,<start date>,<end date>,<title>
-  std::regex meetingCSVPattern(
-      "^\"(.+)\",\"(.+)\",\"(.+)\",\"(.+)\",\"(.+)\"$");
+  this->m_titleIndex.emplace(meeting.getTitle(), t_meeting);
+  this->m_calendarIndex.insert(Date::dateToMinutes(meeting.getStartDate()),
+                               Date::dateToMinutes(meeting.getEndDate()),
+                               t_meeting);
+
+  for (Symbols::Id user : meetingUsers(meeting))
+    this->indexMeetingUser(user, t_meeting);
+}
 
-  for (string line; std::getline(meetingStream, line);) {
-    if (!std::regex_match(line, result, meetingCSVPattern))
-      throw wrong_format("Wrong Meeting CSV Format");
+/**
+ * remove a meeting from the indexes of its sponsor and participators
+ * @param t_meeting the handle of the meeting
+ */
+void Storage::unindexMeeting(MeetingHandle t_meeting) {
+  const Meeting &meeting = this->m_meetings[t_meeting];
+  long long start = Date::dateToMinutes(meeting.getStartDate());
+  auto entry = this->m_titleIndex.find(meeting.getTitle());
 
-    Meeting t_meeting;
+  if (entry != this->m_titleIndex.end() && entry->second == t_meeting)
+    this->m_titleIndex.erase(entry);
 
-    t_meeting.setSponsor(result[1]);
+  this->m_calendarIndex.erase(start, t_meeting);
 
-    string participators = result[2];
-    std::vector<string> t_participators;
-    size_t pos = 0;
-    string delimiter = "&";
+  for (Symbols::Id user : meetingUsers(meeting))
+    this->unindexMeetingUser(user, t_meeting, start);
+}
 
-    // Split a string using delimiter
-    while ((pos = participators.find(delimiter)) != string::npos) {
-      t_participators.push_back(participators.substr(0, pos));
-      participators.erase(0, pos + delimiter.length());
-    }
+/**
+ * apply a switcher to a meeting and move it between indexes if its
+ * sponsor, participators or time change
+ * @param t_meeting the handle of the meeting
+ * @param switcher the method to update the meeting
+ */
+void Storage::switchMeeting(MeetingHandle t_meeting,
+                            const function<void(Meeting &)> &switcher) {
+  Meeting &meeting = this->m_meetings[t_meeting];
+  std::vector<Symbols::Id> before = meetingUsers(meeting);
+  string title = meeting.getTitle();
+  long long start = Date::dateToMinutes(meeting.getStartDate());
+  long long end = Date::dateToMinutes(meeting.getEndDate());
+
+  switcher(meeting);
+
+  if (meeting.getTitle() != title) {
+    auto entry = this->m_titleIndex.find(title);
 
-    t_participators.push_back(participators);
-    t_meeting.setParticipator(t_participators);
-    t_meeting.setStartDate(Date::stringToDate(string(result[3])));
-    t_meeting.setEndDate(Date::stringToDate(string(result[4])));
-    t_meeting.setTitle(result[5]);
+    if (entry != this->m_titleIndex.end() && entry->second == t_meeting)
+      this->m_titleIndex.erase(entry);
 
-    this->m_meetingList.push_back(t_meeting);
+    this->m_titleIndex.emplace(meeting.getTitle(), t_meeting);
   }
 
-  meetingStream.close();
+  std::vector<Symbols::Id> after = meetingUsers(meeting);
+  bool moved = start != Date::dateToMinutes(meeting.getStartDate()) ||
+               end != Date::dateToMinutes(meeting.getEndDate());
 
-  return true;
+  if (moved) {
+    this->m_calendarIndex.erase(start, t_meeting);
+    this->m_calendarIndex.insert(Date::dateToMinutes(meeting.getStartDate()),
+                                 Date::dateToMinutes(meeting.getEndDate()),
+                                 t_meeting);
+  }
+
+  // only touch the users that were added or removed, so the others keep
+  // their posting order, unless the meeting moved in time
+  for (Symbols::Id user : before) {
+    if (moved || std::find(after.begin(), after.end(), user) == after.end())
+      this->unindexMeetingUser(user, t_meeting, start);
+  }
+
+  for (Symbols::Id user : after) {
+    if (moved || std::find(before.begin(), before.end(), user) == before.end())
+      this->indexMeetingUser(user, t_meeting);
+  }
+}
+
+/**
+ * apply a switcher to a user and keep the username index in step with it
+ * @param t_user the handle of the user
+ * @param switcher the method to update the user
+ */
+void Storage::switchUser(UserHandle t_user,
+                         const function<void(User &)> &switcher) {
+  string oldName = this->m_users[t_user].getName();
+
+  switcher(this->m_users[t_user]);
+
+  if (this->m_users[t_user].getName() != oldName) {
+    auto entry = this->m_userIndex.find(oldName);
+
+    if (entry != this->m_userIndex.end() && entry->second == t_user)
+      this->m_userIndex.erase(entry);
+
+    this->indexUser(t_user);
+  }
 }
 
 /**
- * convert the participators list to string
- * @param the source participators list
- * @return the result string
+ * apply a journal record to the tables
+ * the records are keyed by username or title and overwrite whatever they
+ * find, so a key that is missing or already present is not an error:
+ *   U+ <user>            U= <old name>,<user>            U- <name>
+ *   M+ <meeting>         M= <old title>,<meeting>        M- <title>
+ * @param t_record the record
+ * @param t_line the line number of the record in the journal
  */
-string vectorToString(const std::vector<string> &participators) {
-  string result = "";
-  bool isFirstItem = true;
+void Storage::replay(std::string_view t_record, int t_line) {
+  const string at = " at line " + std::to_string(t_line);
+  std::string_view fields[6];
+
+  if (t_record.size() < 4 || t_record[2] != ' ')
+    throw wrong_format("Wrong Journal Format" + at);
+
+  std::string_view tag = t_record.substr(0, 2);
+  std::string_view body = t_record.substr(3);
+
+  if (tag == "U-" || tag == "M-") {
+    if (!Record::split(body, fields, 1, true))
+      throw wrong_format("Wrong Journal Format" + at);
+
+    if (tag == "U-") {
+      auto entry = this->m_userIndex.find(string(fields[0]));
+
+      if (entry != this->m_userIndex.end()) {
+        UserHandle user = entry->second;
 
-  for (auto it = participators.begin(); it != participators.end(); it++) {
-    if (isFirstItem) {
-      isFirstItem = false;
+        this->m_backend->markUser(entry->first);
+        this->unindexUser(user);
+        this->m_users.erase(user);
+      }
     } else {
-      result += "&";
+      auto entry = this->m_titleIndex.find(string(fields[0]));
+
+      if (entry != this->m_titleIndex.end()) {
+        MeetingHandle meeting = entry->second;
+
+        this->m_backend->markMeeting(this->m_meetings[meeting].getSponsor());
+        this->unindexMeeting(meeting);
+        this->m_meetings.erase(meeting);
+      }
     }
+  } else if (tag == "U+" || tag == "U=") {
+    size_t keyed = tag == "U=";
+
+    if (!Record::split(body, fields, 4 + keyed, true))
+      throw wrong_format("Wrong Journal Format" + at);
+
+    User user = Record::parseUser(fields + keyed);
+    auto entry = this->m_userIndex.find(string(fields[0]));
 
-    result += *it;
+    if (entry == this->m_userIndex.end())
+      entry = this->m_userIndex.find(user.getName());
+
+    if (entry != this->m_userIndex.end())
+      this->m_backend->markUser(entry->first);
+
+    this->m_backend->markUser(user.getName());
+
+    if (entry == this->m_userIndex.end()) {
+      this->indexUser(this->m_users.insert(user));
+    } else {
+      this->switchUser(entry->second, [&user](User &t_user) { t_user = user; });
+    }
+  } else if (tag == "M+" || tag == "M=") {
+    size_t keyed = tag == "M=";
+
+    if (!Record::split(body, fields, 5 + keyed, true))
+      throw wrong_format("Wrong Journal Format" + at);
+
+    Meeting meeting = Record::parseMeeting(fields + keyed, at);
+    auto entry = this->m_titleIndex.find(string(fields[keyed ? 0 : 4]));
+
+    if (entry == this->m_titleIndex.end())
+      entry = this->m_titleIndex.find(meeting.getTitle());
+
+    if (entry != this->m_titleIndex.end())
+      this->m_backend->markMeeting(
+          this->m_meetings[entry->second].getSponsor());
+
+    this->m_backend->markMeeting(meeting.getSponsor());
+
+    if (entry == this->m_titleIndex.end()) {
+      this->indexMeeting(this->m_meetings.insert(meeting));
+    } else {
+      this->switchMeeting(entry->second, [&meeting](Meeting &t_meeting) {
+        t_meeting = meeting;
+      });
+    }
+  } else {
+    throw wrong_format("Wrong Journal Format" + at);
   }
+}
 
-  return result;
+/**
+ * rebuild every index from the record slabs
+ */
+void Storage::rebuildIndexes(void) {
+  this->m_userIndex.clear();
+  this->m_titleIndex.clear();
+  this->m_meetingIndex.clear();
+  this->m_scheduleIndex.clear();
+  this->m_userIndex.reserve(this->m_users.size());
+  this->m_titleIndex.reserve(this->m_meetings.size());
+
+  this->m_users.forEach([this](UserHandle user) {
+    this->m_userIndex.emplace(this->m_users[user].getName(), user);
+  });
+  this->rebuildUserFilter();
+  this->m_meetings.forEach([this](MeetingHandle meeting) {
+    this->m_titleIndex.emplace(this->m_meetings[meeting].getTitle(), meeting);
+
+    for (Symbols::Id user : meetingUsers(this->m_meetings[meeting]))
+      this->m_meetingIndex[user].push_back(meeting);
+  });
+
+  this->m_scheduleIndex.reserve(this->m_meetingIndex.size());
+
+  // the calendar and the schedules are built from sorted intervals instead
+  // of one insertion per meeting
+  std::vector<IntervalTree<MeetingHandle>::Interval> intervals;
+  auto byStart = [](const IntervalTree<MeetingHandle>::Interval &t_left,
+                    const IntervalTree<MeetingHandle>::Interval &t_right) {
+    return t_left.start != t_right.start ? t_left.start < t_right.start
+                                         : t_left.value < t_right.value;
+  };
+
+  intervals.reserve(this->m_meetings.size());
+  this->m_meetings.forEach([this, &intervals](MeetingHandle meeting) {
+    const Meeting &record = this->m_meetings[meeting];
+
+    intervals.push_back({Date::dateToMinutes(record.getStartDate()),
+                         Date::dateToMinutes(record.getEndDate()), meeting});
+  });
+  std::sort(intervals.begin(), intervals.end(), byStart);
+  this->m_calendarIndex.assign(intervals);
+
+  for (const auto &entry : this->m_meetingIndex) {
+    intervals.clear();
+
+    for (MeetingHandle meeting : entry.second) {
+      const Meeting &record = this->m_meetings[meeting];
+
+      intervals.push_back({Date::dateToMinutes(record.getStartDate()),
+                           Date::dateToMinutes(record.getEndDate()),
+                           meeting});
+    }
+
+    std::sort(intervals.begin(), intervals.end(), byStart);
+    this->m_scheduleIndex[entry.first].assign(intervals);
+  }
 }
 
 /**
- * write file content from memory
- * @return if success, true will be returned
+ * compact the slabs once tombstones outnumber the live records
  */
-bool Storage::writeToFile(void) {
-  std::ofstream userStream(Path::userPath);
+void Storage::compactIfSparse(void) {
+  // the undo log of a transaction holds handles
+  if (this->m_inTransaction) return;
+
+  // small tables are not worth the index rebuild
+  const std::size_t minTombstones = 1024;
+
+  if ((this->m_users.tombstones() >= minTombstones &&
+       this->m_users.tombstones() > this->m_users.size()) ||
+      (this->m_meetings.tombstones() >= minTombstones &&
+       this->m_meetings.tombstones() > this->m_meetings.size()))
+    this->reclaimTombstones();
+}
 
-  if (userStream.fail()) return false;
+/**
+ * reclaim the tombstones left by deletions and rebuild the indexes
+ */
+void Storage::compact(void) {
+  auto lock = this->writeLock();
 
-  std::ofstream meetingStream(Path::meetingPath);
+  if (this->m_inTransaction) return;
 
-  if (meetingStream.fail()) return false;
+  this->reclaimTombstones();
+}
 
-  for (const User &user : this->m_userList) {
-    userStream << "\"" << user.getName() << "\",";
-    userStream << "\"" << user.getPassword() << "\",";
-    userStream << "\"" << user.getEmail() << "\",";
-    userStream << "\"" << user.getPhone() << "\"\n";
-  }
+/**
+ * reclaim the tombstones left by deletions and rebuild the indexes
+ */
+void Storage::reclaimTombstones(void) {
+  if (this->m_users.tombstones() == 0 && this->m_meetings.tombstones() == 0)
+    return;
 
-  userStream.close();
+  // every index stores handles, which compaction renumbers
+  const std::vector<UserHandle> users = this->m_users.compact();
+  const std::vector<MeetingHandle> meetings = this->m_meetings.compact();
 
-  for (const Meeting &meeting : this->m_meetingList) {
-    meetingStream << "\"" << meeting.getSponsor() << "\",";
-    meetingStream << "\"" << vectorToString(meeting.getParticipator()) << "\",";
-    meetingStream << "\"" << Date::dateToString(meeting.getStartDate())
-                  << "\",";
-    meetingStream << "\"" << Date::dateToString(meeting.getEndDate()) << "\",";
-    meetingStream << "\"" << meeting.getTitle() << "\"\n";
-  }
+  this->rebuildIndexes();
+  this->m_backend->renumber(users, meetings);
+  this->touchAll();
+}
+
+/**
+ * fold the journal into the base files
+ * @return if success, true will be returned
+ */
+bool Storage::checkpoint(void) {
+  this->reclaimTombstones();
 
-  meetingStream.close();
+  if (!this->m_backend->persist(this->m_users, this->m_meetings,
+                                this->m_fsyncPolicy != none))
+    return false;
 
   this->m_dirty = false;
 
   return true;
 }
 
+/**
+ * the partition a username falls in
+ * @param t_userName the username, of the sponsor for a meeting
+ * @return the number of the partition
+ */
+int Storage::partitionOf(const string &t_userName) {
+  return CsvBackend::partitionOf(t_userName);
+}
+
 /**
  * get Instance of storage
  * @return the pointer of the instance
  */
 std::shared_ptr<Storage> Storage::getInstance(void) {
+  std::lock_guard<std::mutex> lock(Storage::m_instanceMutex);
+
   if (Storage::m_instance == nullptr)
-    Storage::m_instance = std::shared_ptr<Storage>(new Storage);
+    Storage::m_instance = Storage::open(Storage::m_backendFactory());
 
   return m_instance;
 }
 
+/**
+ * make an instance of its own
+ * @param t_backend where the tables are kept between runs
+ * @return the pointer of the instance
+ */
+std::shared_ptr<Storage> Storage::open(std::unique_ptr<Backend> t_backend) {
+  return std::shared_ptr<Storage>(new Storage(std::move(t_backend)));
+}
+
+/**
+ * choose the backend of the instances created from now on
+ * @param t_factory makes the backend of an instance
+ */
+void Storage::setBackend(function<std::unique_ptr<Backend>(void)> t_factory) {
+  std::lock_guard<std::mutex> lock(Storage::m_instanceMutex);
+
+  Storage::m_backendFactory = std::move(t_factory);
+}
+
 /**
  * destructor
  */
 Storage::~Storage() {
-  if (this->m_dirty) this->writeToFile();
+  this->stopFlusher();
+
+  if (this->m_dirty) this->checkpoint();
 }
 
 /**
@@ -165,8 +526,22 @@ Storage::~Storage() {
  * @param a user object
  */
 void Storage::createUser(const User &t_user) {
-  this->m_userList.push_back(t_user);
+  auto lock = this->writeLock();
+
+  UserHandle user = this->m_users.insert(t_user);
+
+  this->indexUser(user);
+  this->touchUser(user);
+  this->m_backend->markUser(t_user.getName());
+  this->log("U+ " + Record::encode(t_user));
   this->m_dirty = true;
+
+  if (this->m_inTransaction)
+    this->m_undo.push_back([this, user]() {
+      this->unindexUser(user);
+      this->m_users.erase(user);
+      this->touchUser(user);
+    });
 }
 
 /**
@@ -175,13 +550,7 @@ void Storage::createUser(const User &t_user) {
  * @return a list of fitted users
  */
 list<User> Storage::queryUser(function<bool(const User &)> filter) const {
-  list<User> result;
-
-  for (const User &user : this->m_userList) {
-    if (filter(user)) result.push_back(user);
-  }
-
-  return result;
+  return this->queryUser<UserFilter &>(filter);
 }
 
 /**
@@ -192,18 +561,7 @@ list<User> Storage::queryUser(function<bool(const User &)> filter) const {
  */
 int Storage::updateUser(function<bool(const User &)> filter,
                         function<void(User &)> switcher) {
-  int count = 0;
-
-  for (User &user : this->m_userList) {
-    if (filter(user)) {
-      switcher(user);
-      ++count;
-    }
-  }
-
-  if (count) this->m_dirty = true;
-
-  return count;
+  return this->updateUser<UserFilter &, UserSwitcher &>(filter, switcher);
 }
 
 /**
@@ -212,15 +570,102 @@ int Storage::updateUser(function<bool(const User &)> filter,
  * @return the number of deleted users
  */
 int Storage::deleteUser(function<bool(const User &)> filter) {
-  int size = this->m_userList.size();
+  return this->deleteUser<UserFilter &>(filter);
+}
+
+/**
+ * visit every user without copying it
+ * @param visitor a lambda function called with each user
+ */
+void Storage::forEachUser(function<void(const User &)> visitor) const {
+  this->forEachUser<UserVisitor &>(visitor);
+}
 
-  this->m_userList.remove_if(filter);
+/**
+ * find the first fitted user, the scan stops there
+ * @param a lambda function as the filter
+ * @return the stored user, or nullptr if none fits
+ */
+const User *Storage::firstUser(function<bool(const User &)> filter) const {
+  return this->firstUser<UserFilter &>(filter);
+}
+
+/**
+ * check if any user fits, the scan stops at the first one
+ * @param a lambda function as the filter
+ * @return if a user fits, true will be returned
+ */
+bool Storage::anyUser(function<bool(const User &)> filter) const {
+  return this->anyUser<UserFilter &>(filter);
+}
+
+/**
+ * count the fitted users without copying them
+ * @param a lambda function as the filter
+ * @return the number of fitted users
+ */
+int Storage::countUsers(function<bool(const User &)> filter) const {
+  return this->countUsers<UserFilter &>(filter);
+}
+
+/**
+ * find a user by its name through the username index
+ * @param t_userName the username to look up
+ * @return the stored user, or nullptr if no such user
+ */
+const User *Storage::findUserByName(const string &t_userName) const {
+  auto lock = this->readLock();
+
+  if (!this->mightBeUser(t_userName)) return nullptr;
+
+  auto entry = this->m_userIndex.find(t_userName);
+
+  if (entry == this->m_userIndex.end()) {
+    this->m_filterFalsePositives.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  return &this->m_users[entry->second];
+}
+
+/**
+ * check if a user exists through the username index
+ * @param t_userName the username to look up
+ * @return if the user exists, true will be returned
+ */
+bool Storage::userExists(const string &t_userName) const {
+  auto lock = this->readLock();
+
+  if (!this->mightBeUser(t_userName)) return false;
+
+  if (this->m_userIndex.count(t_userName) != 0) return true;
 
-  int removed = size - this->m_userList.size();
+  this->m_filterFalsePositives.fetch_add(1, std::memory_order_relaxed);
 
-  if (removed) this->m_dirty = true;
+  return false;
+}
 
-  return removed;
+/**
+ * report how well the username filter spares the index
+ * @return the counters of the filter
+ */
+Storage::FilterStats Storage::filterStats(void) const {
+  auto lock = this->readLock();
+  FilterStats stats;
+
+  stats.lookups = this->m_filterLookups.load(std::memory_order_relaxed);
+  stats.rejections = this->m_filterRejections.load(std::memory_order_relaxed);
+  stats.falsePositives =
+      this->m_filterFalsePositives.load(std::memory_order_relaxed);
+  stats.observedRate =
+      stats.rejections + stats.falsePositives == 0
+          ? 0
+          : static_cast<double>(stats.falsePositives) /
+                (stats.rejections + stats.falsePositives);
+  stats.expectedRate = this->m_userFilter.expectedRate();
+  stats.bytes = this->m_userFilter.bytes();
+
+  return stats;
 }
 
 /**
@@ -228,8 +673,22 @@ int Storage::deleteUser(function<bool(const User &)> filter) {
  * @param a meeting object
  */
 void Storage::createMeeting(const Meeting &t_meeting) {
-  this->m_meetingList.push_back(t_meeting);
+  auto lock = this->writeLock();
+
+  MeetingHandle meeting = this->m_meetings.insert(t_meeting);
+
+  this->indexMeeting(meeting);
+  this->touchMeeting(meeting);
+  this->m_backend->markMeeting(t_meeting.getSponsor());
+  this->log("M+ " + Record::encode(t_meeting));
   this->m_dirty = true;
+
+  if (this->m_inTransaction)
+    this->m_undo.push_back([this, meeting]() {
+      this->unindexMeeting(meeting);
+      this->m_meetings.erase(meeting);
+      this->touchMeeting(meeting);
+    });
 }
 
 /**
@@ -239,13 +698,7 @@ void Storage::createMeeting(const Meeting &t_meeting) {
  */
 list<Meeting> Storage::queryMeeting(
     function<bool(const Meeting &)> filter) const {
-  list<Meeting> result;
-
-  for (const Meeting &meeting : this->m_meetingList) {
-    if (filter(meeting)) result.push_back(meeting);
-  }
-
-  return result;
+  return this->queryMeeting<MeetingFilter &>(filter);
 }
 
 /**
@@ -256,38 +709,928 @@ list<Meeting> Storage::queryMeeting(
  */
 int Storage::updateMeeting(function<bool(const Meeting &)> filter,
                            function<void(Meeting &)> switcher) {
-  int count = 0;
+  return this->updateMeeting<MeetingFilter &, MeetingSwitcher &>(filter,
+                                                                 switcher);
+}
 
-  for (Meeting &meeting : this->m_meetingList) {
-    if (filter(meeting)) {
-      switcher(meeting);
-      ++count;
-    }
-  }
+/**
+ * delete meetings
+ * @param a lambda function as the filter
+ * @return the number of deleted meetings
+ */
+int Storage::deleteMeeting(function<bool(const Meeting &)> filter) {
+  return this->deleteMeeting<MeetingFilter &>(filter);
+}
+
+/**
+ * visit every meeting without copying it
+ * @param visitor a lambda function called with each meeting
+ */
+void Storage::forEachMeeting(function<void(const Meeting &)> visitor) const {
+  this->forEachMeeting<MeetingVisitor &>(visitor);
+}
 
-  if (count) this->m_dirty = true;
+/**
+ * find the first fitted meeting, the scan stops there
+ * @param a lambda function as the filter
+ * @return the stored meeting, or nullptr if none fits
+ */
+const Meeting *Storage::firstMeeting(
+    function<bool(const Meeting &)> filter) const {
+  return this->firstMeeting<MeetingFilter &>(filter);
+}
 
-  return count;
+/**
+ * check if any meeting fits, the scan stops at the first one
+ * @param a lambda function as the filter
+ * @return if a meeting fits, true will be returned
+ */
+bool Storage::anyMeeting(function<bool(const Meeting &)> filter) const {
+  return this->anyMeeting<MeetingFilter &>(filter);
 }
 
 /**
- * delete meetings
+ * count the fitted meetings without copying them
+ * @param a lambda function as the filter
+ * @return the number of fitted meetings
+ */
+int Storage::countMeetings(function<bool(const Meeting &)> filter) const {
+  return this->countMeetings<MeetingFilter &>(filter);
+}
+
+/**
+ * query the meetings a user sponsors or takes part in
+ * @param t_userName the sponsor or participator
+ * @param a lambda function as the filter
+ * @return a list of fitted meetings
+ */
+list<Meeting> Storage::queryMeeting(
+    const string &t_userName, function<bool(const Meeting &)> filter) const {
+  return this->queryMeeting<MeetingFilter &>(t_userName, filter);
+}
+
+/**
+ * update the meetings a user sponsors or takes part in
+ * @param t_userName the sponsor or participator
+ * @param a lambda function as the filter
+ * @param a lambda function as the method to update the meeting
+ * @return the number of updated meetings
+ */
+int Storage::updateMeeting(const string &t_userName,
+                           function<bool(const Meeting &)> filter,
+                           function<void(Meeting &)> switcher) {
+  return this->updateMeeting<MeetingFilter &, MeetingSwitcher &>(
+      t_userName, filter, switcher);
+}
+
+/**
+ * delete the meetings a user sponsors or takes part in
+ * @param t_userName the sponsor or participator
  * @param a lambda function as the filter
  * @return the number of deleted meetings
  */
-int Storage::deleteMeeting(function<bool(const Meeting &)> filter) {
-  int size = this->m_meetingList.size();
+int Storage::deleteMeeting(const string &t_userName,
+                           function<bool(const Meeting &)> filter) {
+  return this->deleteMeeting<MeetingFilter &>(t_userName, filter);
+}
 
-  this->m_meetingList.remove_if(filter);
+/**
+ * visit every meeting of a user without copying it
+ * @param t_userName the sponsor or participator
+ * @param visitor a lambda function called with each meeting
+ */
+void Storage::forEachMeeting(const string &t_userName,
+                             function<void(const Meeting &)> visitor) const {
+  this->forEachMeeting<MeetingVisitor &>(t_userName, visitor);
+}
 
-  int removed = size - this->m_meetingList.size();
+/**
+ * find the first fitted meeting of a user, the scan stops there
+ * @param t_userName the sponsor or participator
+ * @param a lambda function as the filter
+ * @return the stored meeting, or nullptr if none fits
+ */
+const Meeting *Storage::firstMeeting(
+    const string &t_userName, function<bool(const Meeting &)> filter) const {
+  return this->firstMeeting<MeetingFilter &>(t_userName, filter);
+}
 
-  if (removed) this->m_dirty = true;
+/**
+ * check if any meeting of a user fits, the scan stops at the first one
+ * @param t_userName the sponsor or participator
+ * @param a lambda function as the filter
+ * @return if a meeting fits, true will be returned
+ */
+bool Storage::anyMeeting(const string &t_userName,
+                         function<bool(const Meeting &)> filter) const {
+  return this->anyMeeting<MeetingFilter &>(t_userName, filter);
+}
 
-  return removed;
+/**
+ * count the fitted meetings of a user without copying them
+ * @param t_userName the sponsor or participator
+ * @param a lambda function as the filter
+ * @return the number of fitted meetings
+ */
+int Storage::countMeetings(const string &t_userName,
+                           function<bool(const Meeting &)> filter) const {
+  return this->countMeetings<MeetingFilter &>(t_userName, filter);
+}
+
+/**
+ * update one user and log it to the journal
+ * @param t_user the handle of the user
+ * @param switcher the method to update the user
+ */
+void Storage::updateUserAt(UserHandle t_user,
+                           const function<void(User &)> &switcher) {
+  const User old = this->m_users[t_user];
+
+  this->switchUser(t_user, switcher);
+  this->touchUser(t_user);
+  this->m_backend->markUser(old.getName());
+  this->m_backend->markUser(this->m_users[t_user].getName());
+  this->log("U= " + Record::quote(old.getName()) + "," +
+            Record::encode(this->m_users[t_user]));
+
+  if (this->m_inTransaction)
+    this->m_undo.push_back([this, t_user, old]() {
+      this->switchUser(t_user, [&old](User &user) { user = old; });
+      this->touchUser(t_user);
+    });
+}
+
+/**
+ * delete one user and log it to the journal
+ * @param t_user the handle of the user
+ */
+void Storage::deleteUserAt(UserHandle t_user) {
+  if (this->m_inTransaction)
+    this->m_undo.push_back([this, t_user, old = this->m_users[t_user]]() {
+      this->m_users.revive(t_user, old);
+      this->indexUser(t_user);
+      this->touchUser(t_user);
+    });
+
+  this->unindexUser(t_user);
+  this->m_backend->markUser(this->m_users[t_user].getName());
+  this->log("U- " + Record::quote(this->m_users[t_user].getName()));
+  this->m_users.erase(t_user);
+  this->touchUser(t_user);
+}
+
+/**
+ * add a user to the username index and filter
+ * @param t_user the handle of the user
+ */
+void Storage::indexUser(UserHandle t_user) {
+  const string &name = this->m_users[t_user].getName();
+
+  this->m_userIndex.emplace(name, t_user);
+  this->m_userFilter.insert(name);
+
+  // past its capacity the filter answers maybe too often
+  if (this->m_userFilter.keys() > this->m_userFilter.capacity())
+    this->rebuildUserFilter();
+}
+
+/**
+ * remove a user from the username index
+ * @param t_user the handle of the user
+ */
+void Storage::unindexUser(UserHandle t_user) {
+  auto entry = this->m_userIndex.find(this->m_users[t_user].getName());
+
+  if (entry != this->m_userIndex.end() && entry->second == t_user)
+    this->m_userIndex.erase(entry);
+
+  // the filter still holds the names of deleted users, which cost as much
+  // as false positives once they outnumber the live ones
+  const std::size_t keys = this->m_userFilter.keys();
+  const std::size_t live = this->m_userIndex.size();
+
+  if (keys > live + userFilterMinimum && keys - live > live)
+    this->rebuildUserFilter();
+}
+
+/**
+ * size the username filter for twice the users and fill it again
+ */
+void Storage::rebuildUserFilter(void) {
+  this->m_userFilter.reset(
+      std::max(2 * this->m_userIndex.size(), userFilterMinimum));
+
+  for (const auto &entry : this->m_userIndex)
+    this->m_userFilter.insert(entry.first);
+}
+
+/**
+ * check the username filter before the index, and count its answers
+ * @param t_userName the username to look up
+ * @return if the user may exist, true will be returned
+ */
+bool Storage::mightBeUser(const string &t_userName) const {
+  this->m_filterLookups.fetch_add(1, std::memory_order_relaxed);
+
+  if (this->m_userFilter.mightContain(t_userName)) return true;
+
+  this->m_filterRejections.fetch_add(1, std::memory_order_relaxed);
+
+  return false;
+}
+
+/**
+ * update one meeting and log it to the journal
+ * @param t_meeting the handle of the meeting
+ * @param switcher the method to update the meeting
+ */
+void Storage::updateMeetingAt(MeetingHandle t_meeting,
+                              const function<void(Meeting &)> &switcher) {
+  const Meeting old = this->m_meetings[t_meeting];
+
+  this->switchMeeting(t_meeting, switcher);
+  this->touchMeeting(t_meeting);
+  this->m_backend->markMeeting(old.getSponsor());
+  this->m_backend->markMeeting(this->m_meetings[t_meeting].getSponsor());
+  this->log("M= " + Record::quote(old.getTitle()) + "," +
+            Record::encode(this->m_meetings[t_meeting]));
+
+  if (this->m_inTransaction)
+    this->m_undo.push_back([this, t_meeting, old]() {
+      this->switchMeeting(t_meeting, [&old](Meeting &meeting) {
+        meeting = old;
+      });
+      this->touchMeeting(t_meeting);
+    });
+}
+
+/**
+ * delete one meeting and log it to the journal
+ * @param t_meeting the handle of the meeting
+ */
+void Storage::deleteMeetingAt(MeetingHandle t_meeting) {
+  if (this->m_inTransaction)
+    this->m_undo.push_back(
+        [this, t_meeting, old = this->m_meetings[t_meeting]]() {
+          this->m_meetings.revive(t_meeting, old);
+          this->indexMeeting(t_meeting);
+          this->touchMeeting(t_meeting);
+        });
+
+  this->m_backend->markMeeting(this->m_meetings[t_meeting].getSponsor());
+  this->log("M- " + Record::quote(this->m_meetings[t_meeting].getTitle()));
+  this->unindexMeeting(t_meeting);
+  this->m_meetings.erase(t_meeting);
+  this->touchMeeting(t_meeting);
+}
+
+/**
+ * log a mutation to the journal, or hold it back until the running
+ * transaction commits
+ * @param t_record the journal record
+ */
+void Storage::log(string t_record) {
+  if (this->m_inTransaction) {
+    this->m_pending.push_back(std::move(t_record));
+  } else {
+    this->m_backend->append(t_record);
+    this->countUnflushed(1);
+  }
+}
+
+/**
+ * count journal records buffered since the last commit
+ * @param t_records the number of new records
+ */
+void Storage::countUnflushed(std::size_t t_records) {
+  if ((this->m_unflushed += t_records) >= this->m_flushThreshold)
+    this->m_flushCondition.notify_one();
+}
+
+/**
+ * @param t_userName the sponsor or participator
+ * @return the meetings of the user, or nullptr if the user has none
+ */
+const std::vector<Storage::MeetingHandle> *Storage::postingsOf(
+    const string &t_userName) const {
+  auto entry = this->m_meetingIndex.find(Symbols::find(t_userName));
+
+  return entry == this->m_meetingIndex.end() ? nullptr : &entry->second;
+}
+
+/**
+ * find a meeting by its title through the title index
+ * @param t_title the title to look up
+ * @return the stored meeting, or nullptr if no such meeting
+ */
+const Meeting *Storage::findMeetingByTitle(const string &t_title) const {
+  auto lock = this->readLock();
+
+  auto entry = this->m_titleIndex.find(t_title);
+
+  if (entry == this->m_titleIndex.end()) return nullptr;
+
+  return &this->m_meetings[entry->second];
+}
+
+/**
+ * update the meeting with a title
+ * @param t_title the title to look up
+ * @param a lambda function as the method to update the meeting
+ * @return the number of updated meetings
+ */
+int Storage::updateMeetingByTitle(const string &t_title,
+                                  function<void(Meeting &)> switcher) {
+  auto lock = this->writeLock();
+
+  auto entry = this->m_titleIndex.find(t_title);
+
+  if (entry == this->m_titleIndex.end()) return 0;
+
+  this->updateMeetingAt(entry->second, switcher);
+  this->m_dirty = true;
+
+  return 1;
+}
+
+/**
+ * delete the meeting with a title
+ * @param t_title the title to look up
+ * @return the number of deleted meetings
+ */
+int Storage::deleteMeetingByTitle(const string &t_title) {
+  auto lock = this->writeLock();
+
+  auto entry = this->m_titleIndex.find(t_title);
+
+  if (entry == this->m_titleIndex.end()) return 0;
+
+  this->deleteMeetingAt(entry->second);
+  this->m_dirty = true;
+  this->compactIfSparse();
+
+  return 1;
+}
+
+/**
+ * find a meeting of a user overlapping a time interval
+ * @param t_userName the sponsor or participator
+ * @param t_startDate the start of the interval
+ * @param t_endDate the end of the interval, excluded
+ * @return the earliest overlapping meeting, or nullptr if the user is free
+ */
+const Meeting *Storage::findTimeConflict(const string &t_userName,
+                                         const Date &t_startDate,
+                                         const Date &t_endDate) const {
+  auto lock = this->readLock();
+
+  auto schedule = this->m_scheduleIndex.find(Symbols::find(t_userName));
+
+  if (schedule == this->m_scheduleIndex.end()) return nullptr;
+
+  const MeetingHandle *conflict = schedule->second.findOverlap(
+      Date::dateToMinutes(t_startDate), Date::dateToMinutes(t_endDate));
+
+  return conflict == nullptr ? nullptr : &this->m_meetings[*conflict];
+}
+
+/**
+ * query the meetings overlapping a time interval
+ * @param t_startDate the start of the interval
+ * @param t_endDate the end of the interval, included
+ * @return the meetings in the order of their start dates
+ */
+list<Meeting> Storage::queryMeeting(const Date &t_startDate,
+                                    const Date &t_endDate) const {
+  auto lock = this->readLock();
+  list<Meeting> result;
+
+  // a meeting ending at the start or starting at the end still overlaps
+  this->m_calendarIndex.forEachOverlap(
+      Date::dateToMinutes(t_startDate) - 1, Date::dateToMinutes(t_endDate) + 1,
+      [this, &result](MeetingHandle meeting) {
+        result.push_back(this->m_meetings[meeting]);
+      });
+
+  return result;
+}
+
+/**
+ * query the meetings of a user overlapping a time interval
+ * @param t_userName the sponsor or participator
+ * @param t_startDate the start of the interval
+ * @param t_endDate the end of the interval, included
+ * @return the meetings in the order of their start dates
+ */
+list<Meeting> Storage::queryMeeting(const string &t_userName,
+                                    const Date &t_startDate,
+                                    const Date &t_endDate) const {
+  auto lock = this->readLock();
+  list<Meeting> result;
+  auto schedule = this->m_scheduleIndex.find(Symbols::find(t_userName));
+
+  if (schedule == this->m_scheduleIndex.end()) return result;
+
+  schedule->second.forEachOverlap(
+      Date::dateToMinutes(t_startDate) - 1, Date::dateToMinutes(t_endDate) + 1,
+      [this, &result](MeetingHandle meeting) {
+        result.push_back(this->m_meetings[meeting]);
+      });
+
+  return result;
 }
 
 /**
  * sync with the file
+ * the journal is flushed, and folded into the base files once it is long
+ */
+bool Storage::sync(void) { return this->commit(false); }
+
+/**
+ * @param t_user a user
+ * @return the bytes its strings hold on the heap
+ */
+static std::size_t payloadOf(const User &t_user) {
+  return payloadOf(t_user.getName()) + payloadOf(t_user.getPassword()) +
+         payloadOf(t_user.getEmail()) + payloadOf(t_user.getPhone());
+}
+
+/**
+ * @param t_meeting a meeting
+ * @return the bytes its title and participators hold on the heap
+ */
+static std::size_t payloadOf(const Meeting &t_meeting) {
+  return payloadOf(t_meeting.getTitle()) +
+         t_meeting.getParticipatorIds().capacity() * sizeof(Symbols::Id);
+}
+
+/**
+ * @param t_id a user id
+ * @return nothing, an id is held in place
+ */
+static std::size_t payloadOf(Symbols::Id /*t_id*/) { return 0; }
+
+/**
+ * @param t_index a hash index keyed by strings or user ids
+ * @return the bytes of its nodes, keys and buckets
  */
-bool Storage::sync(void) { return this->writeToFile(); }
\ No newline at end of file
+template <typename Index>
+static std::size_t indexBytes(const Index &t_index) {
+  // a node holds the entry, the link to the next one and the cached hash
+  std::size_t bytes = t_index.bucket_count() * sizeof(void *);
+
+  for (const auto &entry : t_index)
+    bytes += sizeof(entry) + 2 * sizeof(void *) + payloadOf(entry.first);
+
+  return bytes;
+}
+
+/**
+ * @param t_chunks the chunks of a version
+ * @return the bytes of the chunks and of the records copied in them
+ */
+template <typename T>
+static std::size_t chunkBytes(const std::vector<Version::Chunk<T>> &t_chunks) {
+  std::size_t bytes = t_chunks.capacity() * sizeof(Version::Chunk<T>);
+
+  for (const Version::Chunk<T> &chunk : t_chunks) {
+    bytes += chunk->capacity() * sizeof(T);
+
+    for (const T &record : *chunk) bytes += payloadOf(record);
+  }
+
+  return bytes;
+}
+
+/**
+ * @return the bytes of every component, shared ones aside
+ */
+std::size_t Storage::MemoryStats::total(void) const {
+  return this->userRecords + this->meetingRecords + this->userStrings +
+         this->titleStrings + this->participators + this->userIndex +
+         this->userFilter + this->titleIndex + this->meetingIndex +
+         this->scheduleIndex + this->calendarIndex + this->version +
+         this->backend;
+}
+
+/**
+ * @return the bytes of the components that grow with the meetings
+ */
+std::size_t Storage::MemoryStats::meetingBytes(void) const {
+  return this->meetingRecords + this->titleStrings + this->participators +
+         this->titleIndex + this->meetingIndex + this->scheduleIndex +
+         this->calendarIndex;
+}
+
+/**
+ * measure the memory of the tables, their indexes and caches
+ * @return the bytes of each component
+ */
+Storage::MemoryStats Storage::memoryStats(void) const {
+  auto lock = this->readLock();
+  MemoryStats stats = MemoryStats();
+
+  stats.users = this->m_users.size();
+  stats.meetings = this->m_meetings.size();
+  // a slot holds the record and its live flag
+  stats.userRecords = this->m_users.slots() * (sizeof(User) + 1);
+  stats.meetingRecords = this->m_meetings.slots() * (sizeof(Meeting) + 1);
+
+  this->m_users.forEach([this, &stats](UserHandle handle) {
+    stats.userStrings += payloadOf(this->m_users[handle]);
+  });
+  this->m_meetings.forEach([this, &stats](MeetingHandle handle) {
+    const Meeting &meeting = this->m_meetings[handle];
+
+    stats.titleStrings += payloadOf(meeting.getTitle());
+    stats.participators +=
+        meeting.getParticipatorIds().capacity() * sizeof(Symbols::Id);
+  });
+
+  stats.userIndex = indexBytes(this->m_userIndex);
+  stats.userFilter = this->m_userFilter.bytes();
+  stats.titleIndex = indexBytes(this->m_titleIndex);
+  stats.meetingIndex = indexBytes(this->m_meetingIndex);
+  for (const auto &postings : this->m_meetingIndex)
+    stats.meetingIndex += postings.second.capacity() * sizeof(MeetingHandle);
+  stats.scheduleIndex = indexBytes(this->m_scheduleIndex);
+  for (const auto &schedule : this->m_scheduleIndex)
+    stats.scheduleIndex += schedule.second.bytes();
+  stats.calendarIndex = this->m_calendarIndex.bytes();
+
+  {
+    std::lock_guard<std::mutex> version(this->m_versionMutex);
+
+    if (this->m_version != nullptr)
+      stats.version = chunkBytes(this->m_version->m_users) +
+                      chunkBytes(this->m_version->m_meetings);
+  }
+
+  stats.backend = this->m_backend->footprint();
+
+  return stats;
+}
+
+/**
+ * write the buffered journal records to the file, or fold the journal into
+ * the base files once it is long
+ * @param t_force if the records are forced to the disk whatever the fsync
+ * policy, unless it is none
+ * @return if success, true will be returned
+ */
+bool Storage::commit(bool t_force) {
+  // the lock and the io mutex are taken in this order, so a transaction
+  // must not wait for the io mutex while it holds the lock
+  if (this->m_owner == std::this_thread::get_id()) return false;
+
+  std::lock_guard<std::mutex> io(this->m_ioMutex);
+  auto lock = this->writeLock();
+
+  this->m_unflushed = 0;
+
+  if (this->m_backend->full()) return this->checkpoint();
+
+  this->m_dirty = false;
+
+  bool durable = false;
+
+  if (t_force) {
+    durable = this->m_fsyncPolicy != none;
+  } else if (this->m_fsyncPolicy == perSync ||
+             (this->m_fsyncPolicy == batched &&
+              ++this->m_unsyncedSyncs >= this->m_fsyncBatch)) {
+    durable = true;
+  }
+
+  if (durable) this->m_unsyncedSyncs = 0;
+
+  const string records = this->m_backend->takeChanges();
+
+  // the mutations go on while the records are written
+  if (lock.owns_lock()) lock.unlock();
+
+  if (this->m_backend->writeChanges(records, durable)) return true;
+
+  // the records go back in front of the ones buffered since, so the next
+  // commit writes them again
+  lock = this->writeLock();
+  this->m_backend->restoreChanges(records);
+  this->m_dirty = true;
+  this->m_unflushed += std::count(records.begin(), records.end(), '\n');
+
+  return false;
+}
+
+/**
+ * start a thread that commits the journal in the background
+ * @param t_interval the longest a record waits for a commit
+ * @param t_threshold the number of waiting records that starts a commit
+ */
+void Storage::startFlusher(std::chrono::milliseconds t_interval,
+                           std::size_t t_threshold) {
+  this->stopFlusher();
+  this->setConcurrent(true);
+
+  std::lock_guard<std::mutex> guard(this->m_flushMutex);
+
+  this->m_flushInterval = t_interval;
+  this->m_flushThreshold = t_threshold > 0 ? t_threshold : 1;
+  this->m_flusher = std::thread(&Storage::runFlusher, this);
+}
+
+/**
+ * stop the flusher thread after a last commit
+ */
+void Storage::stopFlusher(void) {
+  {
+    std::lock_guard<std::mutex> guard(this->m_flushMutex);
+
+    if (!this->m_flusher.joinable()) return;
+
+    this->m_flusherStopping = true;
+  }
+
+  this->m_flushCondition.notify_all();
+  this->m_flusher.join();
+
+  std::lock_guard<std::mutex> guard(this->m_flushMutex);
+
+  this->m_flusherStopping = false;
+  this->m_flushThreshold = std::numeric_limits<std::size_t>::max();
+}
+
+/**
+ * the loop of the flusher thread
+ */
+void Storage::runFlusher(void) {
+  std::unique_lock<std::mutex> guard(this->m_flushMutex);
+  bool stopping = false;
+  bool success = true;
+
+  // after a failed commit the next one waits for the interval, the records
+  // it put back are already past the threshold
+  while (!stopping) {
+    this->m_flushCondition.wait_for(
+        guard, this->m_flushInterval, [this, &success]() {
+          return this->m_flusherStopping ||
+                 this->m_flushRequested > this->m_flushCompleted ||
+                 (success && this->m_unflushed >= this->m_flushThreshold);
+        });
+
+    // every flush() asked for so far is answered by this commit
+    const unsigned long long ticket = this->m_flushRequested;
+    const bool forced = ticket > this->m_flushCompleted;
+
+    success = true;
+
+    stopping = this->m_flusherStopping;
+    guard.unlock();
+
+    if (forced || stopping || this->m_unflushed > 0)
+      success = this->commit(forced);
+
+    guard.lock();
+    this->m_flushCompleted = ticket;
+    this->m_flushSucceeded = success;
+    this->m_flushCondition.notify_all();
+  }
+}
+
+/**
+ * wait until the mutations made so far are on disk
+ * @return if success, true will be returned
+ */
+bool Storage::flush(void) {
+  if (this->m_owner == std::this_thread::get_id()) return false;
+
+  std::unique_lock<std::mutex> guard(this->m_flushMutex);
+
+  // a flusher on its way out may already have taken its last ticket
+  if (!this->m_flusher.joinable() || this->m_flusherStopping) {
+    guard.unlock();
+
+    return this->commit(true);
+  }
+
+  const unsigned long long ticket = ++this->m_flushRequested;
+
+  this->m_flushCondition.notify_all();
+  this->m_flushCondition.wait(guard, [this, ticket]() {
+    return this->m_flushCompleted >= ticket;
+  });
+
+  return this->m_flushSucceeded;
+}
+
+/**
+ * write the tables to the binary snapshot, after folding the journal into
+ * the csv files so the snapshot is taken from them
+ * @return if success, true will be returned
+ */
+bool Storage::exportSnapshot(void) {
+  if (this->m_owner == std::this_thread::get_id()) return false;
+
+  std::lock_guard<std::mutex> io(this->m_ioMutex);
+  auto lock = this->writeLock();
+
+  if (!this->m_backend->keepSnapshot()) return false;
+
+  return this->checkpoint();
+}
+
+/**
+ * replace the tables with the binary snapshot and write them to the csv
+ * files
+ * @return if success, true will be returned
+ */
+bool Storage::importSnapshot(void) {
+  if (this->m_owner == std::this_thread::get_id()) return false;
+
+  std::lock_guard<std::mutex> io(this->m_ioMutex);
+  auto lock = this->writeLock();
+
+  if (!this->m_backend->loadSnapshot(this->m_users, this->m_meetings))
+    return false;
+
+  this->rebuildIndexes();
+  this->touchAll();
+
+  return this->checkpoint();
+}
+
+/**
+ * choose when the written files are forced to the disk
+ * @param t_policy none, perSync or batched
+ * @param t_batch the number of syncs in a batch
+ */
+void Storage::setFsyncPolicy(FsyncPolicy t_policy, int t_batch) {
+  auto lock = this->writeLock();
+
+  this->m_fsyncPolicy = t_policy;
+  this->m_fsyncBatch = t_batch > 0 ? t_batch : 1;
+  this->m_unsyncedSyncs = 0;
+}
+
+/**
+ * choose if the instance is shared between threads
+ * @param t_concurrent if the tables are locked
+ */
+void Storage::setConcurrent(bool t_concurrent) {
+  this->m_concurrent = t_concurrent;
+}
+
+/**
+ * @return a shared lock on the tables, held only in concurrent mode
+ */
+std::shared_lock<std::shared_mutex> Storage::readLock(void) const {
+  if (!this->m_concurrent || this->m_owner == std::this_thread::get_id())
+    return std::shared_lock<std::shared_mutex>(this->m_mutex, std::defer_lock);
+
+  return std::shared_lock<std::shared_mutex>(this->m_mutex);
+}
+
+/**
+ * @return an exclusive lock on the tables, held only in concurrent mode
+ */
+std::unique_lock<std::shared_mutex> Storage::writeLock(void) {
+  if (!this->m_concurrent || this->m_owner == std::this_thread::get_id())
+    return std::unique_lock<std::shared_mutex>(this->m_mutex, std::defer_lock);
+
+  return std::unique_lock<std::shared_mutex>(this->m_mutex);
+}
+
+/**
+ * mark the version chunk holding a user as written
+ * @param t_user the handle of the user
+ */
+void Storage::touchUser(UserHandle t_user) {
+  std::size_t chunk = t_user / Version::chunkSize;
+
+  if (chunk < this->m_staleUsers.size()) this->m_staleUsers[chunk] = 1;
+
+  this->m_versionStale = true;
+  this->m_backend->touchUser(t_user);
+}
+
+/**
+ * mark the version chunk holding a meeting as written
+ * @param t_meeting the handle of the meeting
+ */
+void Storage::touchMeeting(MeetingHandle t_meeting) {
+  std::size_t chunk = t_meeting / Version::chunkSize;
+
+  if (chunk < this->m_staleMeetings.size()) this->m_staleMeetings[chunk] = 1;
+
+  this->m_versionStale = true;
+  this->m_backend->touchMeeting(t_meeting);
+}
+
+/**
+ * mark every version chunk as written, after the handles were renumbered
+ */
+void Storage::touchAll(void) {
+  this->m_staleUsers.assign(this->m_staleUsers.size(), 1);
+  this->m_staleMeetings.assign(this->m_staleMeetings.size(), 1);
+  this->m_versionStale = true;
+}
+
+/**
+ * bring the chunks of one table up to date with its slab, sharing the ones
+ * that were not written
+ * @param t_slab the table
+ * @param t_stale which chunks were written, every chunk past its end is new
+ * @param t_chunks the chunks of the last version, updated in place
+ */
+template <typename T>
+static void refreshChunks(const Slab<T> &t_slab,
+                          std::vector<unsigned char> &t_stale,
+                          std::vector<Version::Chunk<T>> &t_chunks) {
+  const std::size_t count =
+      (t_slab.slots() + Version::chunkSize - 1) / Version::chunkSize;
+
+  t_chunks.resize(count);
+  t_stale.resize(count, 1);
+
+  for (std::size_t chunk = 0; chunk < count; ++chunk) {
+    if (t_chunks[chunk] != nullptr && !t_stale[chunk]) continue;
+
+    auto records = std::make_shared<std::vector<T>>();
+    const std::size_t end =
+        std::min(t_slab.slots(), (chunk + 1) * Version::chunkSize);
+
+    for (std::size_t slot = chunk * Version::chunkSize; slot < end; ++slot) {
+      if (t_slab.contains(slot)) records->push_back(t_slab[slot]);
+    }
+
+    t_chunks[chunk] = std::move(records);
+    t_stale[chunk] = 0;
+  }
+}
+
+/**
+ * run several mutations as one unit, undone together if the body throws
+ * @param t_body a lambda function doing the mutations
+ */
+void Storage::transaction(const function<void(void)> &t_body) {
+  if (this->m_owner == std::this_thread::get_id()) {
+    t_body();
+    return;
+  }
+
+  auto lock = this->writeLock();
+  const bool dirty = this->m_dirty;
+
+  this->m_owner = std::this_thread::get_id();
+  this->m_inTransaction = true;
+
+  try {
+    t_body();
+  } catch (...) {
+    for (auto undo = this->m_undo.rbegin(); undo != this->m_undo.rend();
+         ++undo)
+      (*undo)();
+
+    this->m_dirty = dirty;
+    this->m_undo.clear();
+    this->m_pending.clear();
+    this->m_inTransaction = false;
+    this->m_owner = std::thread::id();
+    throw;
+  }
+
+  this->m_backend->appendGroup(this->m_pending);
+
+  if (!this->m_pending.empty()) this->countUnflushed(this->m_pending.size());
+
+  this->m_undo.clear();
+  this->m_pending.clear();
+  this->m_inTransaction = false;
+  this->m_owner = std::thread::id();
+  this->compactIfSparse();
+}
+
+/**
+ * pin the current version of the tables
+ * @return the version, released when its last holder drops it
+ */
+std::shared_ptr<const Version> Storage::pinVersion(void) {
+  auto lock = this->readLock();
+  std::lock_guard<std::mutex> guard(this->m_versionMutex);
+
+  if (this->m_version != nullptr && !this->m_versionStale)
+    return this->m_version;
+
+  auto next = std::make_shared<Version>();
+
+  if (this->m_version != nullptr) *next = *this->m_version;
+
+  refreshChunks(this->m_users, this->m_staleUsers, next->m_users);
+  refreshChunks(this->m_meetings, this->m_staleMeetings, next->m_meetings);
+  ++next->m_number;
+  next->m_userCount = this->m_users.size();
+  next->m_meetingCount = this->m_meetings.size();
+  this->m_version = next;
+  this->m_versionStale = false;
+
+  return this->m_version;
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "Symbols.hpp"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// segment k holds the names of ids [base * (2^k - 1), base * (2^(k+1) - 1)),
+// so the segments never move and 23 of them cover every 32-bit id
+const std::uint64_t segmentBase = 1024;
+const int segmentCount = 23;
+
+struct Slot {
+  std::string name;
+  // the references held, a name is taken out when they reach 0
+  std::atomic<std::uint32_t> references{0};
+};
+
+struct Table {
+  // guards ids, free and the writes of names
+  std::shared_mutex mutex;
+  // the keys view the names kept in the segments
+  std::unordered_map<std::string_view, Symbols::Id> ids;
+  // the ids of the names taken out, given to the next new names
+  std::vector<Symbols::Id> free;
+  std::atomic<Slot *> segments[segmentCount];
+  // the ids given out so far, every id is below it
+  Symbols::Id used;
+
+  Table() : used(1) {
+    for (std::atomic<Slot *> &segment : this->segments) segment = nullptr;
+
+    // id 0 is the empty name, so a default meeting needs no lookup
+    this->segments[0] = new Slot[segmentBase];
+    this->ids.emplace(std::string_view(this->segments[0][0].name),
+                      Symbols::empty);
+  }
+};
+
+/**
+ * @return the table, built on first use as meetings may be built before main.
+ * It is never destroyed, as meetings in static storage release their ids
+ * after it would be
+ */
+Table &table(void) {
+  static Table *instance = new Table;
+
+  return *instance;
+}
+
+/**
+ * find the slot of an id
+ * @param t_id the id
+ * @param t_segment the segment holding the name
+ * @param t_offset the position of the name in the segment
+ */
+void locate(Symbols::Id t_id, int &t_segment, std::uint64_t &t_offset) {
+  const std::uint64_t slot = t_id / segmentBase + 1;
+
+  t_segment = 63 - __builtin_clzll(slot);
+  t_offset = t_id - segmentBase * ((std::uint64_t(1) << t_segment) - 1);
+}
+
+/**
+ * @param t_id an id given out
+ * @return the slot holding the name and references of the id
+ */
+Slot &slotOf(Symbols::Id t_id) {
+  int segment;
+  std::uint64_t offset;
+
+  locate(t_id, segment, offset);
+
+  return table().segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+}  // namespace
+
+/**
+ * get the id of a name and a reference to it, adding the name if it is new
+ * @param t_name the name
+ * @return the id, to be released by the holder
+ */
+Symbols::Id Symbols::intern(std::string_view t_name) {
+  Table &symbols = table();
+
+  // a name found under the shared lock cannot be taken out meanwhile, as
+  // that takes the lock exclusively
+  {
+    std::shared_lock<std::shared_mutex> lock(symbols.mutex);
+    auto entry = symbols.ids.find(t_name);
+
+    if (entry != symbols.ids.end()) {
+      Symbols::retain(entry->second);
+      return entry->second;
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(symbols.mutex);
+  auto entry = symbols.ids.find(t_name);
+
+  // another thread may have added it between the locks
+  if (entry != symbols.ids.end()) {
+    Symbols::retain(entry->second);
+    return entry->second;
+  }
+
+  Id id;
+
+  if (!symbols.free.empty()) {
+    id = symbols.free.back();
+    symbols.free.pop_back();
+  } else {
+    int segment;
+    std::uint64_t offset;
+
+    id = symbols.used++;
+    locate(id, segment, offset);
+
+    if (symbols.segments[segment].load() == nullptr)
+      symbols.segments[segment].store(new Slot[segmentBase << segment],
+                                      std::memory_order_release);
+  }
+
+  Slot &slot = slotOf(id);
+
+  slot.name = std::string(t_name);
+  slot.references.store(1, std::memory_order_relaxed);
+  symbols.ids.emplace(std::string_view(slot.name), id);
+
+  return id;
+}
+
+/**
+ * take one more reference to a held id
+ * @param t_id the id
+ */
+void Symbols::retain(Id t_id) {
+  if (t_id == empty || t_id == none) return;
+
+  slotOf(t_id).references.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * drop a reference to an id, the name goes once nobody holds it
+ * @param t_id the id
+ */
+void Symbols::release(Id t_id) {
+  if (t_id == empty || t_id == none) return;
+
+  Slot &slot = slotOf(t_id);
+
+  if (slot.references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+  Table &symbols = table();
+  std::unique_lock<std::shared_mutex> lock(symbols.mutex);
+
+  // intern may have taken the name again before the lock, or another
+  // release taken it out already
+  if (slot.references.load(std::memory_order_relaxed) != 0) return;
+
+  auto entry = symbols.ids.find(slot.name);
+
+  if (entry == symbols.ids.end() || entry->second != t_id) return;
+
+  symbols.ids.erase(entry);
+  std::string().swap(slot.name);
+  symbols.free.push_back(t_id);
+}
+
+/**
+ * look up the id of a name without adding it or holding it
+ * @param t_name the name
+ * @return the id, or none if the name is not found
+ */
+Symbols::Id Symbols::find(std::string_view t_name) {
+  Table &symbols = table();
+  std::shared_lock<std::shared_mutex> lock(symbols.mutex);
+  auto entry = symbols.ids.find(t_name);
+
+  return entry == symbols.ids.end() ? none : entry->second;
+}
+
+/**
+ * @param t_id a held id
+ * @return the name of the id
+ */
+const std::string &Symbols::name(Id t_id) { return slotOf(t_id).name; }
+
+/**
+ * @return the number of names held, the empty one included
+ */
+std::size_t Symbols::size(void) {
+  Table &symbols = table();
+  std::shared_lock<std::shared_mutex> lock(symbols.mutex);
+
+  return symbols.ids.size();
+}
+
+/**
+ * @return the bytes the names and their lookup table take
+ */
+std::size_t Symbols::bytes(void) {
+  Table &symbols = table();
+  std::shared_lock<std::shared_mutex> lock(symbols.mutex);
+  // a node of the lookup table holds the entry and the link to the next one
+  std::size_t bytes =
+      symbols.ids.bucket_count() * sizeof(void *) +
+      symbols.ids.size() *
+          (sizeof(std::pair<std::string_view, Id>) + sizeof(void *)) +
+      symbols.free.capacity() * sizeof(Id);
+
+  for (int segment = 0; segment < segmentCount; ++segment) {
+    const Slot *slots = symbols.segments[segment].load();
+
+    if (slots == nullptr) continue;
+
+    const std::uint64_t count = segmentBase << segment;
+
+    bytes += count * sizeof(Slot);
+
+    // a name short enough to fit in place takes no heap
+    for (std::uint64_t slot = 0; slot < count; ++slot)
+      if (slots[slot].name.capacity() >= sizeof(std::string) / 2)
+        bytes += slots[slot].name.capacity() + 1;
+  }
+
+  return bytes;
+}
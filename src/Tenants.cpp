@@ -0,0 +1,189 @@
+#include "Tenants.hpp"
+#include <sys/stat.h>
+#include <algorithm>  // any_of
+#include <cctype>     // isspace iscntrl
+#include <utility>
+
+using std::string;
+
+/**
+ * @param t_tenant the name of a tenant
+ * @return if it names a directory right under the root, with no blank or
+ * control character in it, true will be returned
+ */
+static bool plainName(const string &t_tenant) {
+  return !t_tenant.empty() && t_tenant != "." && t_tenant != ".." &&
+         t_tenant.find('/') == string::npos &&
+         std::none_of(t_tenant.begin(), t_tenant.end(), [](char t_char) {
+           const unsigned char c = static_cast<unsigned char>(t_char);
+
+           return std::isspace(c) || std::iscntrl(c);
+         });
+}
+
+/**
+ * constructor
+ * @param t_root the directory holding a data directory per tenant
+ * @param t_engine the storage engine of every tenant
+ */
+Tenants::Tenants(const string &t_root, const string &t_engine)
+    : m_root(t_root), m_engine(t_engine) {}
+
+/**
+ * wait until a tenant is neither being loaded nor evicted
+ * @param t_lock the lock on the registry
+ * @param t_tenant the name of the tenant
+ */
+void Tenants::waitIdle(std::unique_lock<std::mutex> &t_lock,
+                       const string &t_tenant) {
+  this->m_idle.wait(t_lock, [this, &t_tenant]() {
+    return this->m_busy.count(t_tenant) == 0;
+  });
+}
+
+/**
+ * get the storage of a tenant, loading it if it is not resident
+ * @param t_tenant the name of the tenant
+ * @return the storage, or nullptr if the name or the engine is not valid
+ */
+std::shared_ptr<Storage> Tenants::open(const string &t_tenant) {
+  if (!plainName(t_tenant)) return nullptr;
+
+  std::unique_lock<std::mutex> lock(this->m_mutex);
+
+  this->waitIdle(lock, t_tenant);
+
+  auto entry = this->m_tenants.find(t_tenant);
+
+  if (entry != this->m_tenants.end() && entry->second.storage != nullptr) {
+    entry->second.lastOpened = Clock::now();
+    return entry->second.storage;
+  }
+
+  // the tables are read outside the lock, so other tenants are served
+  // meanwhile
+  this->m_busy.insert(t_tenant);
+  lock.unlock();
+
+  std::shared_ptr<Storage> storage;
+
+  try {
+    const string directory = this->m_root + "/" + t_tenant;
+
+    mkdir(this->m_root.c_str(), 0755);
+    mkdir(directory.c_str(), 0755);
+
+    std::unique_ptr<Backend> backend =
+        Backend::create(this->m_engine, directory);
+
+    if (backend != nullptr) {
+      storage = Storage::open(std::move(backend));
+      storage->setConcurrent(true);
+    }
+  } catch (...) {
+    lock.lock();
+    this->m_busy.erase(t_tenant);
+    this->m_idle.notify_all();
+    throw;
+  }
+
+  lock.lock();
+  this->m_busy.erase(t_tenant);
+  this->m_idle.notify_all();
+
+  if (storage == nullptr) return nullptr;
+
+  Entry &loaded = this->m_tenants[t_tenant];
+
+  loaded.storage = storage;
+  loaded.lastOpened = Clock::now();
+
+  return storage;
+}
+
+/**
+ * evict the tenants nobody else holds and nobody opened for a while
+ * @param t_idle how long a tenant must have been idle
+ * @return the number of tenants evicted
+ */
+std::size_t Tenants::evictIdle(Clock::duration t_idle) {
+  std::vector<std::pair<string, std::shared_ptr<Storage>>> evicted;
+
+  {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    const Clock::time_point now = Clock::now();
+
+    for (auto &entry : this->m_tenants) {
+      std::shared_ptr<Storage> &storage = entry.second.storage;
+
+      // nobody can take a new copy without the lock, so one holder is us
+      if (storage == nullptr || storage.use_count() > 1 ||
+          now - entry.second.lastOpened < t_idle)
+        continue;
+
+      evicted.emplace_back(entry.first, std::move(storage));
+      this->m_busy.insert(entry.first);
+    }
+  }
+
+  // persisting the tables runs outside the lock, an open of an evicted
+  // tenant waits for it to finish
+  std::vector<std::size_t> bytes;
+
+  for (auto &tenant : evicted) {
+    bytes.push_back(tenant.second->memoryStats().total());
+    tenant.second.reset();
+  }
+
+  std::lock_guard<std::mutex> lock(this->m_mutex);
+
+  for (std::size_t i = 0; i < evicted.size(); ++i) {
+    this->m_tenants[evicted[i].first].bytes = bytes[i];
+    this->m_busy.erase(evicted[i].first);
+  }
+
+  this->m_idle.notify_all();
+
+  return evicted.size();
+}
+
+/**
+ * @return the number of tenants whose tables are loaded
+ */
+std::size_t Tenants::resident(void) const {
+  std::lock_guard<std::mutex> lock(this->m_mutex);
+  std::size_t count = 0;
+
+  for (const auto &entry : this->m_tenants)
+    if (entry.second.storage != nullptr) ++count;
+
+  return count;
+}
+
+/**
+ * measure the memory of every tenant opened so far
+ * @return the usage of each tenant
+ */
+std::vector<Tenants::Usage> Tenants::usage(void) const {
+  std::vector<Usage> result;
+  std::vector<std::shared_ptr<Storage>> storages;
+
+  {
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    const Clock::time_point now = Clock::now();
+
+    for (const auto &entry : this->m_tenants) {
+      result.push_back({entry.first, entry.second.storage != nullptr,
+                        entry.second.bytes, now - entry.second.lastOpened});
+      storages.push_back(entry.second.storage);
+    }
+  }
+
+  // the storages are concurrent, so they are measured under their own locks
+  for (std::size_t i = 0; i < result.size(); ++i) {
+    if (storages[i] != nullptr)
+      result[i].bytes = storages[i]->memoryStats().total();
+  }
+
+  return result;
+}
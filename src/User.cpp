@@ -23,7 +23,7 @@ User::User(const User &t_user)
  * @brief get the name of the user
  * @return   return a string indicate the name of the user
  */
-std::string User::getName() const { return this->m_name; }
+const std::string &User::getName() const { return this->m_name; }
 
 /**
  * @brief set the name of the user
@@ -35,7 +35,7 @@ void User::setName(const std::string &t_name) { this->m_name = t_name; }
  * @brief get the password of the user
  * @return   return a string indicate the password of the user
  */
-std::string User::getPassword() const { return this->m_password; }
+const std::string &User::getPassword() const { return this->m_password; }
 
 /**
  * @brief set the password of the user
@@ -49,7 +49,7 @@ void User::setPassword(const std::string &t_password) {
  * @brief get the email of the user
  * @return   return a string indicate the email of the user
  */
-std::string User::getEmail() const { return this->m_email; }
+const std::string &User::getEmail() const { return this->m_email; }
 
 /**
  * @brief set the email of the user
@@ -61,7 +61,7 @@ void User::setEmail(const std::string &t_email) { this->m_email = t_email; }
  * @brief get the phone of the user
  * @return   return a string indicate the phone of the user
  */
-std::string User::getPhone() const { return this->m_phone; }
+const std::string &User::getPhone() const { return this->m_phone; }
 
 /**
  * @brief set the phone of the user
@@ -8,4 +8,5 @@ gtest/bin/UserTest
 gtest/bin/MeetingTest
 gtest/bin/DateTest
 gtest/bin/StorageTest
+gtest/bin/StorageStressTest
 gtest/bin/AgendaServiceTest